@@ -195,25 +195,50 @@ NSString * const IgnoreCodePushMetadata = @".codepushrelease";
     return AssetsFolderName;
 }
 
++ (NSString *)binaryHashCacheKeyForBundleAtURL:(NSURL *)binaryBundleUrl
+{
+    // The binary contents can only change when the app is updated, so the cached hash is keyed by
+    // both the app version and the modified date of the JS bundle that shipped with it.
+    NSString *binaryModifiedDate = [self modifiedDateStringOfFileAtURL:binaryBundleUrl];
+    if (binaryModifiedDate == nil) {
+        return nil;
+    }
+
+    NSString *appVersion = [[CodePushConfig current] appVersion] ?: @"";
+    return [NSString stringWithFormat:@"%@:%@", appVersion, binaryModifiedDate];
+}
+
 + (NSString *)getHashForBinaryContents:(NSURL *)binaryBundleUrl
                                  error:(NSError **)error
 {
+    static NSString *memoizedCacheKey = nil;
+    static NSString *memoizedBinaryHash = nil;
+
+    NSString *cacheKey = [self binaryHashCacheKeyForBundleAtURL:binaryBundleUrl];
+    @synchronized (self) {
+        if (cacheKey != nil && [cacheKey isEqualToString:memoizedCacheKey]) {
+            return memoizedBinaryHash;
+        }
+    }
+
     // Get the cached hash from user preferences if it exists.
-    NSString *binaryModifiedDate = [self modifiedDateStringOfFileAtURL:binaryBundleUrl];
     NSUserDefaults *preferences = [NSUserDefaults standardUserDefaults];
-    NSMutableDictionary *binaryHashDictionary = [preferences objectForKey:BinaryHashKey];
+    NSDictionary *binaryHashDictionary = [preferences objectForKey:BinaryHashKey];
     NSString *binaryHash = nil;
     if (binaryHashDictionary != nil) {
-        binaryHash = [binaryHashDictionary objectForKey:binaryModifiedDate];
+        binaryHash = cacheKey ? [binaryHashDictionary objectForKey:cacheKey] : nil;
         if (binaryHash == nil) {
             [preferences removeObjectForKey:BinaryHashKey];
             [preferences synchronize];
         } else {
+            @synchronized (self) {
+                memoizedCacheKey = cacheKey;
+                memoizedBinaryHash = binaryHash;
+            }
             return binaryHash;
         }
     }
     
-    binaryHashDictionary = [NSMutableDictionary dictionary];
     NSMutableArray *manifest = [NSMutableArray array];
     
     // If the app is using assets, then add
@@ -234,12 +259,18 @@ NSString * const IgnoreCodePushMetadata = @".codepushrelease";
     [self addFileToManifest:[binaryBundleUrl URLByAppendingPathExtension:@"meta"] manifest:manifest];
 
     binaryHash = [self computeFinalHashFromManifest:manifest error:error];
+    if (binaryHash == nil || cacheKey == nil) {
+        return binaryHash;
+    }
     
     // Cache the hash in user preferences. This assumes that the modified date for the
     // JS bundle changes every time a new bundle is generated by the packager.
-    [binaryHashDictionary setObject:binaryHash forKey:binaryModifiedDate];
-    [preferences setObject:binaryHashDictionary forKey:BinaryHashKey];
+    [preferences setObject:@{ cacheKey: binaryHash } forKey:BinaryHashKey];
     [preferences synchronize];
+    @synchronized (self) {
+        memoizedCacheKey = cacheKey;
+        memoizedBinaryHash = binaryHash;
+    }
     return binaryHash;
 }
 
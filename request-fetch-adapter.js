@@ -1,5 +1,11 @@
+const { NativeModules } = require("react-native");
 const packageJson = require("./package.json");
 
+// Where the native module provides it (Windows), requests go through the same native HTTP client
+// as package downloads, so an update check and the download that follows it share a connection.
+const NativeCodePush = NativeModules.CodePush;
+const nativeRequest = NativeCodePush && NativeCodePush.request;
+
 module.exports = {
   async request(verb, url, requestBody, callback) {
     if (typeof requestBody === "function") {
@@ -20,6 +26,12 @@ module.exports = {
     }
 
     try {
+      if (nativeRequest) {
+        const { statusCode, body } = await nativeRequest(getHttpMethodName(verb), url, headers, requestBody || "");
+        callback(null, { statusCode, body });
+        return;
+      }
+
       const response = await fetch(url, {
         method: getHttpMethodName(verb),
         headers: headers,
@@ -9,6 +9,9 @@
 #include "winrt/Windows.Foundation.Collections.h"
 #include "winrt/Windows.Storage.h"
 
+#include <algorithm>
+#include <cwctype>
+
 namespace winrt::Microsoft::CodePush::ReactNative::implementation
 {
     using namespace Windows::Storage;
@@ -38,6 +41,14 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
         std::optional<hstring> deploymentKey;
         std::optional<hstring> publicKey;
         std::optional<hstring> serverUrl;
+        std::optional<hstring> bundlePrewarmBudget;
+        std::optional<hstring> httpRequestTimeout;
+        std::optional<hstring> httpReadTimeout;
+        std::optional<hstring> downloadMirrors;
+        std::optional<hstring> downloadHedgeDelay;
+        std::optional<hstring> downloadMinThroughput;
+        std::optional<hstring> installBudget;
+        std::optional<hstring> packageCacheBudget;
 
         if (configMap != nullptr)
         {
@@ -46,6 +57,14 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
             deploymentKey = configMap.TryLookup(DeploymentKeyConfigKey);
             publicKey = configMap.TryLookup(PublicKeyKey);
             serverUrl = configMap.TryLookup(ServerURLConfigKey);
+            bundlePrewarmBudget = configMap.TryLookup(BundlePrewarmBudgetConfigKey);
+            httpRequestTimeout = configMap.TryLookup(HttpRequestTimeoutConfigKey);
+            httpReadTimeout = configMap.TryLookup(HttpReadTimeoutConfigKey);
+            downloadMirrors = configMap.TryLookup(DownloadMirrorsConfigKey);
+            downloadHedgeDelay = configMap.TryLookup(DownloadHedgeDelayConfigKey);
+            downloadMinThroughput = configMap.TryLookup(DownloadMinThroughputConfigKey);
+            installBudget = configMap.TryLookup(InstallBudgetConfigKey);
+            packageCacheBudget = configMap.TryLookup(PackageCacheBudgetConfigKey);
         }
 
         CodePushConfig& currentConfig = Current();
@@ -76,6 +95,14 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
         addToConfiguration(DeploymentKeyConfigKey, deploymentKey);
         addToConfiguration(PublicKeyKey, publicKey);
         addToConfiguration(ServerURLConfigKey, serverUrl);
+        addToConfiguration(BundlePrewarmBudgetConfigKey, bundlePrewarmBudget);
+        addToConfiguration(HttpRequestTimeoutConfigKey, httpRequestTimeout);
+        addToConfiguration(HttpReadTimeoutConfigKey, httpReadTimeout);
+        addToConfiguration(DownloadMirrorsConfigKey, downloadMirrors);
+        addToConfiguration(DownloadHedgeDelayConfigKey, downloadHedgeDelay);
+        addToConfiguration(DownloadMinThroughputConfigKey, downloadMinThroughput);
+        addToConfiguration(InstallBudgetConfigKey, installBudget);
+        addToConfiguration(PackageCacheBudgetConfigKey, packageCacheBudget);
 
         currentConfig.m_configuration.Insert(ClientUniqueIDConfigKey, clientUniqueId);
 
@@ -87,6 +114,95 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
         ::Microsoft::CodePush::ReactNative::CodePushNativeModule::LoadBundle();
     }
 
+    uint64_t CodePushConfig::GetBundlePrewarmBudget()
+    {
+        auto budget{ QueryConfig(BundlePrewarmBudgetConfigKey) };
+        return budget.empty() ? 0 : _wcstoui64(budget.c_str(), nullptr, 10);
+    }
+
+    Windows::Foundation::TimeSpan CodePushConfig::GetHttpRequestTimeout()
+    {
+        return QueryTimeout(HttpRequestTimeoutConfigKey, DefaultHttpTimeoutMilliseconds);
+    }
+
+    Windows::Foundation::TimeSpan CodePushConfig::GetHttpReadTimeout()
+    {
+        return QueryTimeout(HttpReadTimeoutConfigKey, DefaultHttpTimeoutMilliseconds);
+    }
+
+    std::vector<hstring> CodePushConfig::GetDownloadUrls(std::wstring_view downloadUrl)
+    {
+        std::vector<hstring> downloadUrls{ hstring{ downloadUrl } };
+
+        std::vector<std::wstring_view> mirrors;
+        auto mirrorsConfig{ QueryConfig(DownloadMirrorsConfigKey) };
+        std::wstring_view remaining{ mirrorsConfig };
+        while (!remaining.empty())
+        {
+            const auto separator{ remaining.find(L',') };
+            auto mirror{ remaining.substr(0, separator) };
+            remaining = separator == std::wstring_view::npos ? std::wstring_view{} : remaining.substr(separator + 1);
+
+            while (!mirror.empty() && iswspace(mirror.front()))
+            {
+                mirror.remove_prefix(1);
+            }
+            while (!mirror.empty() && iswspace(mirror.back()))
+            {
+                mirror.remove_suffix(1);
+            }
+            if (!mirror.empty())
+            {
+                mirrors.push_back(mirror);
+            }
+        }
+
+        const auto source{ std::find_if(mirrors.begin(), mirrors.end(), [downloadUrl](std::wstring_view mirror) {
+            return downloadUrl.size() >= mirror.size() && _wcsnicmp(downloadUrl.data(), mirror.data(), mirror.size()) == 0;
+        }) };
+        if (source != mirrors.end())
+        {
+            const auto path{ downloadUrl.substr(source->size()) };
+            const auto sourceIndex{ static_cast<size_t>(source - mirrors.begin()) };
+            for (size_t i{ 1 }; i < mirrors.size(); i++)
+            {
+                auto const& prefix{ mirrors[(sourceIndex + i) % mirrors.size()] };
+                downloadUrls.push_back(hstring{ std::wstring{ prefix }.append(path) });
+            }
+        }
+        return downloadUrls;
+    }
+
+    Windows::Foundation::TimeSpan CodePushConfig::GetDownloadHedgeDelay()
+    {
+        return QueryTimeout(DownloadHedgeDelayConfigKey, 0);
+    }
+
+    uint64_t CodePushConfig::GetDownloadMinThroughput()
+    {
+        auto throughput{ QueryConfig(DownloadMinThroughputConfigKey) };
+        return throughput.empty() ? 0 : _wcstoui64(throughput.c_str(), nullptr, 10);
+    }
+
+    uint64_t CodePushConfig::GetInstallBudget()
+    {
+        auto budget{ QueryConfig(InstallBudgetConfigKey) };
+        return budget.empty() ? 0 : _wcstoui64(budget.c_str(), nullptr, 10);
+    }
+
+    uint64_t CodePushConfig::GetPackageCacheBudget()
+    {
+        auto budget{ QueryConfig(PackageCacheBudgetConfigKey) };
+        return budget.empty() ? 0 : _wcstoui64(budget.c_str(), nullptr, 10);
+    }
+
+    Windows::Foundation::TimeSpan CodePushConfig::QueryTimeout(std::wstring_view key, uint64_t defaultMilliseconds)
+    {
+        auto timeout{ QueryConfig(key) };
+        const uint64_t milliseconds{ timeout.empty() ? defaultMilliseconds : _wcstoui64(timeout.c_str(), nullptr, 10) };
+        return std::chrono::milliseconds{ static_cast<int64_t>(milliseconds) };
+    }
+
     hstring CodePushConfig::QueryConfig(std::wstring_view key)
     {
         auto value{ m_configuration.TryLookup(key) };
@@ -7,6 +7,7 @@
 #include "NativeModules.h"
 
 #include <string_view>
+#include <vector>
 #include "winrt/Microsoft.ReactNative.h"
 #include "winrt/Windows.Data.Json.h"
 #include "winrt/Windows.Foundation.Collections.h"
@@ -38,6 +39,30 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
         hstring GetPublicKey() { return QueryConfig(PublicKeyKey); }
         void SetPublicKey(std::wstring_view publicKey) { m_configuration.Insert(PublicKeyKey, publicKey); }
 
+        // Maximum number of bundle bytes to read ahead before the bundle is loaded. 0 disables prewarming.
+        uint64_t GetBundlePrewarmBudget();
+
+        // How long to wait for a response, and for each read of its content, before giving up. 0 waits indefinitely.
+        Windows::Foundation::TimeSpan GetHttpRequestTimeout();
+        Windows::Foundation::TimeSpan GetHttpReadTimeout();
+
+        // The URLs a package can be downloaded from: downloadUrl, then the same path on each other mirror
+        // in downloadMirrors (a comma-separated list of URL prefixes) when downloadUrl starts with one of them.
+        std::vector<hstring> GetDownloadUrls(std::wstring_view downloadUrl);
+
+        // How long to wait for a mirror's response before also asking the next one. 0 only moves on when a mirror fails.
+        Windows::Foundation::TimeSpan GetDownloadHedgeDelay();
+
+        // Bytes per second below which a download moves to the next mirror. 0 never moves a download that is progressing.
+        uint64_t GetDownloadMinThroughput();
+
+        // Maximum number of bytes installing one update may write. 0 leaves only the free space to limit it.
+        uint64_t GetInstallBudget();
+
+        // Bytes of disk that packages other than the current and previous one may keep, so that switching back to one
+        // of them doesn't download it again. 0 keeps none.
+        uint64_t GetPackageCacheBudget();
+
     private:
         static constexpr std::wstring_view AppVersionConfigKey{ L"appVersion" };
         static constexpr std::wstring_view BuildVersionConfigKey{ L"buildVersion" };
@@ -45,10 +70,20 @@ namespace winrt::Microsoft::CodePush::ReactNative::implementation
         static constexpr std::wstring_view DeploymentKeyConfigKey{ L"deploymentKey" };
         static constexpr std::wstring_view ServerURLConfigKey{ L"serverUrl" };
         static constexpr std::wstring_view PublicKeyKey{ L"publicKey" };
+        static constexpr std::wstring_view BundlePrewarmBudgetConfigKey{ L"bundlePrewarmBudget" };
+        static constexpr std::wstring_view HttpRequestTimeoutConfigKey{ L"httpRequestTimeout" };
+        static constexpr std::wstring_view HttpReadTimeoutConfigKey{ L"httpReadTimeout" };
+        static constexpr uint32_t DefaultHttpTimeoutMilliseconds{ 30000 };
+        static constexpr std::wstring_view DownloadMirrorsConfigKey{ L"downloadMirrors" };
+        static constexpr std::wstring_view DownloadHedgeDelayConfigKey{ L"downloadHedgeDelay" };
+        static constexpr std::wstring_view DownloadMinThroughputConfigKey{ L"downloadMinThroughput" };
+        static constexpr std::wstring_view InstallBudgetConfigKey{ L"installBudget" };
+        static constexpr std::wstring_view PackageCacheBudgetConfigKey{ L"packageCacheBudget" };
 
         Windows::Foundation::Collections::IMap<hstring, hstring> m_configuration;
 
         hstring QueryConfig(std::wstring_view key);
+        Windows::Foundation::TimeSpan QueryTimeout(std::wstring_view key, uint64_t defaultMilliseconds);
     };
 }
 
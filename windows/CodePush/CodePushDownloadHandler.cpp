@@ -10,7 +10,20 @@
 #include "winrt/Windows.Web.Http.h"
 #include "winrt/Windows.Web.Http.Headers.h"
 
+#include "CodePushConfig.h"
 #include "CodePushDownloadHandler.h"
+#include "CodePushExecutor.h"
+#include "CodePushHttpClient.h"
+#include "CodePushInstallReservation.h"
+#include "CodePushUtils.h"
+
+#include "miniz/miniz.h"
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace Microsoft::CodePush::ReactNative
 {
@@ -29,42 +42,663 @@ namespace Microsoft::CodePush::ReactNative
         progressCallback(progressCallback),
         downloadFile(downloadFile) {}
 
-    IAsyncOperation<bool> CodePushDownloadHandler::Download(std::wstring_view url)
+    struct SalvageCrc
+    {
+        uint32_t crc;
+        uint64_t size;
+    };
+
+    // Returns how much of a partially downloaded zip can be kept: the length of the prefix made of
+    // complete entries whose data matches their CRC. The central directory at the end of the archive
+    // hasn't arrived, so entries are found by walking their local headers from the start.
+    static uint64_t GetSalvageableZipLength(uint8_t const* data, uint64_t length)
+    {
+        constexpr uint32_t localHeaderSignature{ 0x04034b50 };
+        constexpr uint32_t dataDescriptorSignature{ 0x08074b50 };
+        constexpr uint64_t localHeaderSize{ 30 };
+        constexpr uint32_t hasDataDescriptorFlag{ 0x8 };
+
+        auto read16 = [data](uint64_t offset) { return static_cast<uint32_t>(data[offset] | (data[offset + 1] << 8)); };
+        auto read32 = [&read16](uint64_t offset) { return read16(offset) | (read16(offset + 2) << 16); };
+
+        uint64_t salvaged{ 0 };
+        while (salvaged + localHeaderSize <= length && read32(salvaged) == localHeaderSignature)
+        {
+            const auto hasDataDescriptor{ (read16(salvaged + 6) & hasDataDescriptorFlag) != 0 };
+            const auto method{ read16(salvaged + 8) };
+            auto crc{ read32(salvaged + 14) };
+            uint64_t compressedSize{ read32(salvaged + 18) };
+            uint64_t uncompressedSize{ read32(salvaged + 22) };
+            const auto dataOffset{ salvaged + localHeaderSize + read16(salvaged + 26) + read16(salvaged + 28) };
+            if (dataOffset > length || compressedSize == UINT32_MAX || uncompressedSize == UINT32_MAX)
+            {
+                break;
+            }
+
+            // Without a data descriptor the sizes are known up front; with one, inflating finds the end
+            SalvageCrc actual{ static_cast<uint32_t>(MZ_CRC32_INIT), 0 };
+            size_t consumed{ 0 };
+            if (method == MZ_DEFLATED)
+            {
+                if (!hasDataDescriptor && compressedSize > length - dataOffset)
+                {
+                    break;
+                }
+                consumed = static_cast<size_t>(hasDataDescriptor ? length - dataOffset : compressedSize);
+                auto putBuffer = [](const void* buffer, int size, void* user) {
+                    auto& crc{ *static_cast<SalvageCrc*>(user) };
+                    crc.crc = static_cast<uint32_t>(mz_crc32(crc.crc, static_cast<uint8_t const*>(buffer), size));
+                    crc.size += size;
+                    return 1;
+                };
+                if (!tinfl_decompress_mem_to_callback(data + dataOffset, &consumed, putBuffer, &actual, 0))
+                {
+                    break;
+                }
+            }
+            else if (method == 0 && !hasDataDescriptor && compressedSize <= length - dataOffset)
+            {
+                consumed = static_cast<size_t>(compressedSize);
+                actual = { static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, data + dataOffset, consumed)), compressedSize };
+            }
+            else
+            {
+                break;
+            }
+
+            auto end{ dataOffset + consumed };
+            if (hasDataDescriptor)
+            {
+                if (end + 4 <= length && read32(end) == dataDescriptorSignature)
+                {
+                    end += 4;
+                }
+                if (end + 12 > length)
+                {
+                    break;
+                }
+                crc = read32(end);
+                compressedSize = read32(end + 4);
+                uncompressedSize = read32(end + 8);
+                end += 12;
+            }
+
+            if (actual.crc != crc || actual.size != uncompressedSize || consumed != compressedSize)
+            {
+                break;
+            }
+            salvaged = end;
+        }
+        return salvaged;
+    }
+
+    // The same for the first length bytes of the file at path, read through a read-only view so that the partial
+    // download isn't copied into memory. Returns 0 (start over) if the file can't be mapped.
+    static uint64_t GetSalvageableZipLength(hstring const& path, uint64_t length)
     {
-        HttpClient client;
+        file_handle file{ ::CreateFile2(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING, nullptr) };
+        LARGE_INTEGER fileSize{};
+        if (!file || !::GetFileSizeEx(file.get(), &fileSize))
+        {
+            return 0;
+        }
+
+        length = (std::min)(length, static_cast<uint64_t>(fileSize.QuadPart));
+        if (length == 0)
+        {
+            return 0;
+        }
+
+        handle mapping{ ::CreateFileMappingFromApp(file.get(), nullptr, PAGE_READONLY, 0, nullptr) };
+        if (!mapping)
+        {
+            return 0;
+        }
+
+        auto view{ ::MapViewOfFileFromApp(mapping.get(), FILE_MAP_READ, 0, static_cast<SIZE_T>(length)) };
+        if (view == nullptr)
+        {
+            return 0;
+        }
+
+        const auto salvaged{ GetSalvageableZipLength(static_cast<uint8_t const*>(view), length) };
+        ::UnmapViewOfFile(view);
+        return salvaged;
+    }
+
+    // Decodes a gzip or deflate Content-Encoding as the response arrives, with the zlib API of miniz
+    class ContentDecoder
+    {
+    public:
+        // Returns nullptr for the identity coding; codings other than the ones the request accepts aren't supported
+        static std::unique_ptr<ContentDecoder> Create(std::wstring_view coding)
+        {
+            const std::wstring name{ coding };
+            if (name.empty() || _wcsicmp(name.c_str(), L"identity") == 0)
+            {
+                return nullptr;
+            }
+            if (_wcsicmp(name.c_str(), L"gzip") == 0 || _wcsicmp(name.c_str(), L"x-gzip") == 0)
+            {
+                return std::unique_ptr<ContentDecoder>{ new ContentDecoder{ true } };
+            }
+            if (_wcsicmp(name.c_str(), L"deflate") == 0)
+            {
+                return std::unique_ptr<ContentDecoder>{ new ContentDecoder{ false } };
+            }
+            throw hresult_error(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), L"Unsupported content encoding: " + hstring{ coding });
+        }
+
+        ~ContentDecoder()
+        {
+            mz_inflateEnd(&m_stream);
+        }
+
+        ContentDecoder(ContentDecoder const&) = delete;
+        ContentDecoder& operator=(ContentDecoder const&) = delete;
+
+        // Decodes input into output until output is full or input can't make any more progress, advancing
+        // input past what was consumed. Returns the number of bytes written to output.
+        size_t Decode(uint8_t const*& input, size_t& inputSize, uint8_t* output, size_t outputSize)
+        {
+            size_t produced{ 0 };
+            for (;;)
+            {
+                switch (m_state)
+                {
+                case State::GzipHeader:
+                case State::GzipTrailer:
+                {
+                    if (inputSize == 0)
+                    {
+                        return produced;
+                    }
+                    m_wrapper.push_back(*input++);
+                    inputSize--;
+
+                    if (m_state == State::GzipHeader)
+                    {
+                        if (IsGzipHeaderComplete())
+                        {
+                            m_state = State::Body;
+                        }
+                    }
+                    else if (m_wrapper.size() == GzipTrailerSize)
+                    {
+                        const auto crc{ ReadLE32(0) };
+                        const auto size{ ReadLE32(4) };
+                        if (crc != m_crc || size != m_size)
+                        {
+                            throw hresult_error(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), L"The gzip response failed its CRC check.");
+                        }
+                        m_state = State::Finished;
+                    }
+                    break;
+                }
+
+                case State::Body:
+                {
+                    if (produced == outputSize)
+                    {
+                        return produced;
+                    }
+                    m_stream.next_in = input;
+                    m_stream.avail_in = static_cast<mz_uint32>((std::min)(inputSize, size_t{ UINT32_MAX }));
+                    m_stream.next_out = output + produced;
+                    m_stream.avail_out = static_cast<mz_uint32>((std::min)(outputSize - produced, size_t{ UINT32_MAX }));
+                    const auto availableIn{ m_stream.avail_in };
+                    const auto availableOut{ m_stream.avail_out };
+
+                    const auto status{ mz_inflate(&m_stream, MZ_NO_FLUSH) };
+                    const size_t consumed{ availableIn - m_stream.avail_in };
+                    const size_t written{ availableOut - m_stream.avail_out };
+                    if (status != MZ_OK && status != MZ_STREAM_END && status != MZ_BUF_ERROR)
+                    {
+                        throw hresult_error(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), L"Unable to decode the compressed response.");
+                    }
+
+                    m_crc = static_cast<uint32_t>(mz_crc32(m_crc, output + produced, written));
+                    m_size += static_cast<uint32_t>(written);
+                    input += consumed;
+                    inputSize -= consumed;
+                    produced += written;
+
+                    if (status == MZ_STREAM_END)
+                    {
+                        m_wrapper.clear();
+                        m_state = m_isGzip ? State::GzipTrailer : State::Finished;
+                    }
+                    else if (consumed == 0 && written == 0)
+                    {
+                        return produced;
+                    }
+                    break;
+                }
+
+                case State::Finished:
+                    // Anything after the end of the stream isn't part of the content
+                    input += inputSize;
+                    inputSize = 0;
+                    return produced;
+                }
+            }
+        }
+
+        bool IsFinished() const
+        {
+            return m_state == State::Finished;
+        }
+
+    private:
+        enum class State
+        {
+            GzipHeader,
+            Body,
+            GzipTrailer,
+            Finished
+        };
+
+        static constexpr size_t GzipHeaderSize{ 10 };
+        static constexpr size_t GzipTrailerSize{ 8 };
 
-        auto headers{ client.DefaultRequestHeaders() };
-        headers.Append(L"Accept-Encoding", L"identity");
+        explicit ContentDecoder(bool isGzip) : m_isGzip{ isGzip }, m_state{ isGzip ? State::GzipHeader : State::Body }
+        {
+            // A gzip member wraps a raw deflate stream; the deflate coding is a zlib stream
+            if (mz_inflateInit2(&m_stream, isGzip ? -MZ_DEFAULT_WINDOW_BITS : MZ_DEFAULT_WINDOW_BITS) != MZ_OK)
+            {
+                throw hresult_error(E_OUTOFMEMORY);
+            }
+        }
+
+        uint32_t ReadLE32(size_t offset) const
+        {
+            return m_wrapper[offset] | (m_wrapper[offset + 1] << 8) | (m_wrapper[offset + 2] << 16) | (static_cast<uint32_t>(m_wrapper[offset + 3]) << 24);
+        }
 
-        HttpRequestMessage reqm{ HttpMethod::Get(), Uri(url) };
-        auto resm{ co_await client.SendRequestAsync(reqm, HttpCompletionOption::ResponseHeadersRead) };
-        expectedContentLength = resm.Content().Headers().ContentLength().GetInt64();
-        auto inputStream{ co_await resm.Content().ReadAsInputStreamAsync() };
+        // The header is 10 bytes, followed by the optional fields its flags announce (RFC 1952)
+        bool IsGzipHeaderComplete() const
+        {
+            constexpr uint8_t hasHeaderCrc{ 0x2 };
+            constexpr uint8_t hasExtra{ 0x4 };
+            constexpr uint8_t hasName{ 0x8 };
+            constexpr uint8_t hasComment{ 0x10 };
+
+            auto const& header{ m_wrapper };
+            if (header.size() < GzipHeaderSize)
+            {
+                return false;
+            }
+            if (header[0] != 0x1f || header[1] != 0x8b || header[2] != MZ_DEFLATED)
+            {
+                throw hresult_error(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), L"The response is not valid gzip content.");
+            }
+
+            const auto flags{ header[3] };
+            size_t length{ GzipHeaderSize };
+            if (flags & hasExtra)
+            {
+                if (header.size() < length + 2)
+                {
+                    return false;
+                }
+                length += 2 + (header[length] | (header[length + 1] << 8));
+            }
+            for (auto field : { hasName, hasComment })
+            {
+                if (flags & field)
+                {
+                    do
+                    {
+                        if (header.size() <= length)
+                        {
+                            return false;
+                        }
+                    } while (header[length++] != 0);
+                }
+            }
+            if (flags & hasHeaderCrc)
+            {
+                length += 2;
+            }
+            return header.size() == length;
+        }
+
+        const bool m_isGzip;
+        State m_state;
+        mz_stream m_stream{};
+        std::vector<uint8_t> m_wrapper;
+        uint32_t m_crc{ static_cast<uint32_t>(MZ_CRC32_INIT) };
+        uint32_t m_size{ 0 };
+    };
+
+    IAsyncOperation<HttpResponseMessage> CodePushDownloadHandler::SendHedgedRequestAsync(std::function<HttpRequestMessage(hstring const&)> createRequest)
+    {
+        const auto hedgeDelay{ CodePushConfig::Current().GetDownloadHedgeDelay() };
+
+        // Signalled whenever one of the requests completes; shared with their handlers, which can outlive this call
+        auto signal{ std::make_shared<handle>(check_pointer(::CreateEventW(nullptr, /*bManualReset*/ true, /*bInitialState*/ false, nullptr))) };
+
+        // requests[i] goes to downloadUrls[(urlIndex + i) % downloadUrls.size()]
+        std::vector<IAsyncOperation<HttpResponseMessage>> requests;
+        auto startRequest = [&]() {
+            const auto& requestUrl{ downloadUrls[(urlIndex + requests.size()) % downloadUrls.size()] };
+            if (!requests.empty())
+            {
+                CodePushUtils::Log(L"[CodePush] Also requesting the package from mirror " + requestUrl);
+            }
+            auto request{ CodePushHttpClient::SendRequestAsync(createRequest(requestUrl), HttpCompletionOption::ResponseHeadersRead) };
+            request.Completed([signal](auto&&, auto&&) { ::SetEvent(signal->get()); });
+            requests.push_back(request);
+        };
+
+        startRequest();
+        for (;;)
+        {
+            ::ResetEvent(signal->get());
+
+            // The first successful response wins. One that answered without the package only counts
+            // if nothing better comes, and one that failed is only rethrown if every URL failed.
+            size_t finished{ 0 };
+            std::optional<size_t> answered;
+            std::optional<size_t> winner;
+            for (size_t i{ 0 }; i < requests.size() && !winner; i++)
+            {
+                const auto status{ requests[i].Status() };
+                if (status == AsyncStatus::Started)
+                {
+                    continue;
+                }
+                finished++;
+                if (status == AsyncStatus::Completed)
+                {
+                    if (requests[i].GetResults().IsSuccessStatusCode())
+                    {
+                        winner = i;
+                    }
+                    else if (!answered)
+                    {
+                        answered = i;
+                    }
+                }
+            }
+
+            const bool canHedge{ requests.size() < downloadUrls.size() };
+            if (!winner && finished == requests.size() && !canHedge)
+            {
+                // GetResults rethrows the error of a request that failed
+                winner = answered ? *answered : 0;
+            }
+            if (winner)
+            {
+                for (auto const& request : requests)
+                {
+                    if (request.Status() == AsyncStatus::Started)
+                    {
+                        request.Cancel();
+                    }
+                }
+                auto response{ requests[*winner].GetResults() };
+                urlIndex = (urlIndex + *winner) % downloadUrls.size();
+                co_return response;
+            }
+
+            if (finished == requests.size())
+            {
+                startRequest();
+            }
+            else if (canHedge && hedgeDelay.count() > 0)
+            {
+                if (!co_await resume_on_signal(signal->get(), hedgeDelay))
+                {
+                    startRequest();
+                }
+            }
+            else
+            {
+                co_await resume_on_signal(signal->get());
+            }
+        }
+    }
+
+    IAsyncOperation<bool> CodePushDownloadHandler::Download(std::wstring_view url)
+    {
         auto outputStream{ co_await downloadFile.OpenAsync(FileAccessMode::ReadWrite) };
 
+        if (buffers.empty())
+        {
+            for (uint32_t i{ 0 }; i < BufferCount; i++)
+            {
+                buffers.emplace_back(BufferSize);
+            }
+        }
+
+        downloadUrls = CodePushConfig::Current().GetDownloadUrls(url);
+        urlIndex = 0;
+        const auto minThroughput{ downloadUrls.size() > 1 ? CodePushConfig::Current().GetDownloadMinThroughput() : 0 };
+
         uint8_t header[4] = {};
+        hstring validator;
+        hstring validatorUrl;
+        uint32_t resumeAttempts{ 0 };
+        size_t slowMirrorSwitches{ 0 };
+
+        // The bytes written to the file so far; receivedContentLength counts the bytes received, which
+        // are fewer when the response is compressed
+        int64_t fileLength{ 0 };
+        auto sniffHeader = [&header, &fileLength](IBuffer const& buffer) {
+            for (uint32_t i{ 0 }; fileLength + i < ARRAYSIZE(header) && i < buffer.Length(); i++)
+            {
+                header[fileLength + i] = buffer.data()[i];
+            }
+        };
 
         for (;;)
         {
-            auto outputBuffer{ co_await inputStream.ReadAsync(Buffer{ BufferSize }, BufferSize, InputStreamOptions::None) };
+            // Continue an interrupted download where the salvaged bytes end, as long as the server
+            // still has the same file; otherwise it answers with the whole file and we start over.
+            // Only a fresh request accepts a compressed response, since resuming one would need the decoder's state.
+            // A mirror has validators of its own, so one is only sent back to the URL it came from;
+            // the package hash is checked once the download is complete either way.
+            auto createRequest = [&](hstring const& requestUrl) {
+                HttpRequestMessage reqm{ HttpMethod::Get(), Uri(requestUrl) };
+                reqm.Headers().Append(L"Accept-Encoding", fileLength > 0 ? L"identity" : L"gzip, deflate");
+                if (fileLength > 0)
+                {
+                    reqm.Headers().Append(L"Range", L"bytes=" + to_hstring(fileLength) + L"-");
+                    if (!validator.empty() && requestUrl == validatorUrl)
+                    {
+                        reqm.Headers().Append(L"If-Range", validator);
+                    }
+                }
+                return reqm;
+            };
 
-            if (outputBuffer.Length() == 0)
+            auto resm{ co_await SendHedgedRequestAsync(createRequest) };
+            if (fileLength > 0 && resm.StatusCode() != HttpStatusCode::PartialContent)
             {
-                break;
+                CodePushUtils::Log(L"[CodePush] Server did not resume the download, starting over.");
+                fileLength = 0;
             }
-            co_await outputStream.WriteAsync(outputBuffer);
+            if (fileLength == 0)
+            {
+                receivedContentLength = 0;
+                // A compressed response is often sent chunked, without a length; 0 leaves it unknown
+                auto contentLength{ resm.Content().Headers().ContentLength() };
+                expectedContentLength = contentLength ? contentLength.GetInt64() : 0;
+                auto const& responseHeaders{ resm.Headers() };
+                validator = responseHeaders.HasKey(L"ETag") ? responseHeaders.Lookup(L"ETag") :
+                    responseHeaders.HasKey(L"Last-Modified") ? responseHeaders.Lookup(L"Last-Modified") : hstring{};
+                validatorUrl = downloadUrls[urlIndex];
 
-            if (receivedContentLength < ARRAYSIZE(header))
+                // Don't start on an archive the disk can't hold (installing it is checked once it is here)
+                const auto freeBytes{ CodePushInstallReservation::GetFreeBytes(std::wstring{ downloadFile.Path() }) };
+                if (expectedContentLength > 0 && static_cast<uint64_t>(expectedContentLength) > freeBytes)
+                {
+                    throw hresult_error(HRESULT_FROM_WIN32(ERROR_DISK_FULL),
+                        L"The update is " + to_hstring(expectedContentLength) + L" bytes, but only " + to_hstring(freeBytes) + L" are free.");
+                }
+            }
+
+            std::unique_ptr<ContentDecoder> decoder;
+            for (auto const& coding : resm.Content().Headers().ContentEncoding())
+            {
+                if (auto codingDecoder{ ContentDecoder::Create(coding.ContentCoding()) })
+                {
+                    if (decoder)
+                    {
+                        throw hresult_error(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), L"Multiple content encodings are not supported.");
+                    }
+                    decoder = std::move(codingDecoder);
+                }
+            }
+            if (decoder && decodedBuffers.empty())
             {
-                for (uint32_t i{ static_cast<uint32_t>(receivedContentLength) }; i < min(ARRAYSIZE(header), outputBuffer.Length()); i++)
+                for (uint32_t i{ 0 }; i < BufferCount; i++)
                 {
-                    header[i] = outputBuffer.data()[i];
+                    decodedBuffers.emplace_back(DecodedBufferSize);
                 }
             }
 
-            receivedContentLength += outputBuffer.Length();
+            outputStream.Size(static_cast<uint64_t>(fileLength));
+            outputStream.Seek(static_cast<uint64_t>(fileLength));
+            auto inputStream{ co_await resm.Content().ReadAsInputStreamAsync() };
 
-            progressCallback(/*expectedContentLength*/ expectedContentLength, /*receivedContentLength*/ receivedContentLength);
+            hresult_error readError;
+            bool failed{ false };
+            bool tooSlow{ false };
+            IAsyncOperationWithProgress<uint32_t, uint32_t> pendingWrite{ nullptr };
+            uint32_t pendingLength{ 0 };
+            uint32_t pendingReceivedLength{ 0 };
+            auto throughputWindowStart{ std::chrono::steady_clock::now() };
+            uint64_t throughputWindowLength{ 0 };
+            for (uint32_t slot{ 0 };; slot = (slot + 1) % BufferCount)
+            {
+                // The buffers in this slot were last written two reads ago, and that write has completed
+                IBuffer outputBuffer{ nullptr };
+                try
+                {
+                    outputBuffer = co_await CodePushHttpClient::ReadAsync(inputStream, buffers[slot], BufferSize);
+                }
+                catch (hresult_error const& ex)
+                {
+                    readError = ex;
+                    failed = true;
+                }
+
+                // Decoding is CPU work, so it moves back to a worker from the thread the read completed on
+                if (decoder)
+                {
+                    co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+                }
+
+                // A mirror that has slowed down is given up on, to resume from the next one, until each has had its turn.
+                // A compressed response would have to start over, so it stays where it is.
+                if (minThroughput > 0 && slowMirrorSwitches + 1 < downloadUrls.size() && !decoder && !failed)
+                {
+                    throughputWindowLength += outputBuffer.Length();
+                    const auto elapsed{ std::chrono::steady_clock::now() - throughputWindowStart };
+                    if (elapsed >= ThroughputWindow)
+                    {
+                        const auto throughput{ throughputWindowLength * 1000 / std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() };
+                        if (throughput < minThroughput)
+                        {
+                            CodePushUtils::Log(L"[CodePush] Download from " + downloadUrls[urlIndex] + L" slowed to " + to_hstring(throughput) + L" bytes per second.");
+                            tooSlow = true;
+                            failed = true;
+                        }
+                        throughputWindowStart = std::chrono::steady_clock::now();
+                        throughputWindowLength = 0;
+                    }
+                }
+
+                // Writes to the file go one at a time, so the previous one has to finish before this one starts
+                if (pendingWrite)
+                {
+                    co_await pendingWrite;
+                    pendingWrite = nullptr;
+                    fileLength += pendingLength;
+                    receivedContentLength += pendingReceivedLength;
+
+                    progressCallback(/*expectedContentLength*/ expectedContentLength, /*receivedContentLength*/ receivedContentLength);
+                }
+
+                if (failed || outputBuffer.Length() == 0)
+                {
+                    break;
+                }
+
+                // A compressed response is decoded into a buffer of its own, and what doesn't fit is written right away
+                IBuffer fileBuffer{ outputBuffer };
+                if (decoder)
+                {
+                    auto& decoded{ decodedBuffers[slot] };
+                    uint8_t const* input{ outputBuffer.data() };
+                    size_t inputSize{ outputBuffer.Length() };
+                    decoded.Length(0);
+                    for (;;)
+                    {
+                        const auto produced{ decoder->Decode(input, inputSize, decoded.data() + decoded.Length(), decoded.Capacity() - decoded.Length()) };
+                        decoded.Length(decoded.Length() + static_cast<uint32_t>(produced));
+                        if (decoded.Length() < decoded.Capacity())
+                        {
+                            break;
+                        }
+
+                        sniffHeader(decoded);
+                        co_await outputStream.WriteAsync(decoded);
+                        fileLength += decoded.Length();
+                        decoded.Length(0);
+                    }
+                    fileBuffer = decoded;
+                }
+
+                sniffHeader(fileBuffer);
+                pendingWrite = outputStream.WriteAsync(fileBuffer);
+                pendingLength = fileBuffer.Length();
+                pendingReceivedLength = outputBuffer.Length();
+            }
+
+            const bool isTruncated{ failed ||
+                (expectedContentLength > 0 && receivedContentLength < expectedContentLength) ||
+                (decoder && !decoder->IsFinished()) };
+            if (!isTruncated)
+            {
+                break;
+            }
+            if (tooSlow)
+            {
+                slowMirrorSwitches++;
+            }
+            if ((!tooSlow && ++resumeAttempts > MaxResumeAttempts) || fileLength > UINT32_MAX)
+            {
+                if (failed && !tooSlow)
+                {
+                    throw readError;
+                }
+                break;
+            }
+
+            // Keep only what can be trusted: for a zip, the complete entries that pass their CRC check.
+            // A compressed response starts over.
+            const auto truncatedLength{ fileLength };
+            const bool isZipSoFar{ header[0] == 'P' && header[1] == 'K' && header[2] == 3 && header[3] == 4 };
+            if (decoder)
+            {
+                fileLength = 0;
+            }
+            else if (isZipSoFar)
+            {
+                co_await outputStream.FlushAsync();
+                fileLength = static_cast<int64_t>(GetSalvageableZipLength(downloadFile.Path(), static_cast<uint64_t>(fileLength)));
+            }
+            receivedContentLength = fileLength;
+
+            CodePushUtils::Log(L"[CodePush] Download truncated at " + to_hstring(truncatedLength) + L" bytes, resuming from " + to_hstring(fileLength));
+            if (failed && downloadUrls.size() > 1)
+            {
+                urlIndex = (urlIndex + 1) % downloadUrls.size();
+                CodePushUtils::Log(L"[CodePush] Resuming from mirror " + downloadUrls[urlIndex]);
+            }
         }
 
         bool isZip{ header[0] == 'P' && header[1] == 'K' && header[2] == 3 && header[3] == 4 };
@@ -4,10 +4,13 @@
 #pragma once
 
 #include "winrt/Windows.Storage.h"
+#include "winrt/Windows.Storage.Streams.h"
+#include "winrt/Windows.Web.Http.h"
 #include "winrt/Windows.Foundation.h"
 #include "winrt/Windows.Data.Json.h"
 #include <string_view>
 #include <functional>
+#include <vector>
 
 namespace Microsoft::CodePush::ReactNative
 {
@@ -23,10 +26,35 @@ namespace Microsoft::CodePush::ReactNative
 			winrt::Windows::Storage::StorageFile downloadFile,
 			std::function<void(int64_t, int64_t)> progressCallback);
 
-		// Returns true if the downloaded file is a zip file
+		// Returns true if the downloaded file is a zip file. A response that ends early is resumed with a
+		// Range request, from the end of its last complete zip entry (or of the received bytes otherwise).
+		// The server may compress the response with gzip or deflate; it's decoded as it arrives, and
+		// progress counts the compressed bytes against the compressed Content-Length.
+		// With downloadMirrors configured, a slow or failing mirror is raced against or replaced by the
+		// next one (see CodePushConfig::GetDownloadUrls).
 		winrt::Windows::Foundation::IAsyncOperation<bool> Download(std::wstring_view url);
 
 	private:
 		static constexpr uint32_t BufferSize{ 256 * 1024 };
+		// One buffer is written to the file while the next is read from the network
+		static constexpr uint32_t BufferCount{ 2 };
+		// A compressed response decodes into these, so that most reads fit in one write
+		static constexpr uint32_t DecodedBufferSize{ 4 * BufferSize };
+		static constexpr uint32_t MaxResumeAttempts{ 3 };
+		// How often the throughput of a download is checked against downloadMinThroughput
+		static constexpr winrt::Windows::Foundation::TimeSpan ThroughputWindow{ std::chrono::seconds{ 3 } };
+
+		std::vector<winrt::hstring> downloadUrls;
+		size_t urlIndex{ 0 };
+
+		// Reused across reads and resumed requests rather than allocated for every read
+		std::vector<winrt::Windows::Storage::Streams::Buffer> buffers;
+		std::vector<winrt::Windows::Storage::Streams::Buffer> decodedBuffers;
+
+		// Sends the request created for the current download URL and, when it fails or hasn't answered
+		// within the hedge delay, for the next ones. Returns the first successful response, cancels
+		// the others, and makes the URL that answered the current one.
+		winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Web::Http::HttpResponseMessage> SendHedgedRequestAsync(
+			std::function<winrt::Windows::Web::Http::HttpRequestMessage(winrt::hstring const&)> createRequest);
 	};
 }
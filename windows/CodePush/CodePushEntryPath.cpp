@@ -0,0 +1,238 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Doesn't use the precompiled header, so that it also builds with the portable tests in windows\CodePushTests
+#include "CodePushEntryPath.h"
+
+#include <algorithm>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    constexpr char32_t ReplacementCharacter{ 0xFFFD };
+
+    // Decodes the code point at name[i] and moves i past it. Each maximal subpart of an invalid
+    // sequence decodes to one U+FFFD, which leaves the byte that made it invalid to be decoded next.
+    static char32_t DecodeUtf8(std::string_view name, size_t& i) noexcept
+    {
+        const auto lead{ static_cast<uint8_t>(name[i++]) };
+        if (lead < 0x80)
+        {
+            return lead;
+        }
+
+        size_t continuationCount;
+        char32_t codePoint;
+        uint8_t low{ 0x80 };
+        uint8_t high{ 0xBF };
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            continuationCount = 1;
+            codePoint = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            // Neither overlong, nor a surrogate
+            continuationCount = 2;
+            codePoint = lead & 0x0F;
+            if (lead == 0xE0) low = 0xA0;
+            if (lead == 0xED) high = 0x9F;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            // Neither overlong, nor past U+10FFFF
+            continuationCount = 3;
+            codePoint = lead & 0x07;
+            if (lead == 0xF0) low = 0x90;
+            if (lead == 0xF4) high = 0x8F;
+        }
+        else
+        {
+            return ReplacementCharacter;
+        }
+
+        for (; continuationCount > 0; continuationCount--)
+        {
+            if (i == name.size())
+            {
+                return ReplacementCharacter;
+            }
+            const auto next{ static_cast<uint8_t>(name[i]) };
+            if (next < low || next > high)
+            {
+                return ReplacementCharacter;
+            }
+            codePoint = (codePoint << 6) | (next & 0x3F);
+            i++;
+            low = 0x80;
+            high = 0xBF;
+        }
+        return codePoint;
+    }
+
+    static bool IsInvalidChar(char32_t ch) noexcept
+    {
+        switch (ch)
+        {
+        case U'<': case U'>': case U':': case U'"':
+        case U'/': case U'\\': case U'|': case U'?': case U'*':
+            return true;
+        default:
+            return ch < 0x20; // control chars not allowed in names
+        }
+    }
+
+    // CON, PRN, AUX, NUL, COM1-9 and LPT1-9, in any case
+    static bool IsReservedDeviceName(std::wstring_view name) noexcept
+    {
+        if (name.size() != 3 && name.size() != 4)
+        {
+            return false;
+        }
+
+        wchar_t upper[4];
+        for (size_t i{ 0 }; i < name.size(); i++)
+        {
+            upper[i] = name[i] >= L'a' && name[i] <= L'z' ? static_cast<wchar_t>(name[i] - L'a' + L'A') : name[i];
+        }
+
+        const std::wstring_view prefix{ upper, 3 };
+        if (name.size() == 3)
+        {
+            return prefix == L"CON" || prefix == L"PRN" || prefix == L"AUX" || prefix == L"NUL";
+        }
+        return (prefix == L"COM" || prefix == L"LPT") && upper[3] >= L'1' && upper[3] <= L'9';
+    }
+
+    bool CodePushEntryPath::Parse(std::string_view name)
+    {
+        m_length = 0;
+        m_overflowed = false;
+        m_overflow.clear();
+
+        size_t segmentStart{ 0 };
+        size_t i{ 0 };
+        for (;;)
+        {
+            if (i == name.size() || name[i] == '/' || name[i] == '\\')
+            {
+                const auto kept{ EndSegment(segmentStart) };
+                if (i == name.size())
+                {
+                    return kept;
+                }
+
+                i++;
+                if (m_length > 0)
+                {
+                    Append(L'\\');
+                }
+                segmentStart = m_length;
+                continue;
+            }
+
+            const auto codePoint{ DecodeUtf8(name, i) };
+            if (codePoint >= 0x10000)
+            {
+                Append(static_cast<wchar_t>(0xD800 + ((codePoint - 0x10000) >> 10)));
+                Append(static_cast<wchar_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+            }
+            else
+            {
+                Append(IsInvalidChar(codePoint) ? L'_' : static_cast<wchar_t>(codePoint));
+            }
+        }
+    }
+
+    std::wstring_view CodePushEntryPath::PathWithoutSegments(size_t count) const noexcept
+    {
+        auto path{ Path() };
+        for (; count > 0; count--)
+        {
+            const auto separator{ path.find(L'\\') };
+            if (separator == std::wstring_view::npos)
+            {
+                return {};
+            }
+            path.remove_prefix(separator + 1);
+        }
+        return path;
+    }
+
+    std::wstring_view CodePushEntryPath::FileName() const noexcept
+    {
+        const auto path{ Path() };
+        const auto separator{ path.rfind(L'\\') };
+        return separator == std::wstring_view::npos ? path : path.substr(separator + 1);
+    }
+
+    void CodePushEntryPath::Append(wchar_t ch)
+    {
+        if (!m_overflowed && m_length == InlineCapacity)
+        {
+            m_overflow.assign(m_inline, m_length);
+            m_overflowed = true;
+        }
+
+        if (m_overflowed)
+        {
+            m_overflow.push_back(ch);
+        }
+        else
+        {
+            m_inline[m_length] = ch;
+        }
+        m_length++;
+    }
+
+    void CodePushEntryPath::Truncate(size_t length) noexcept
+    {
+        m_length = length;
+        if (m_overflowed)
+        {
+            m_overflow.resize(length);
+        }
+    }
+
+    // Finishes the segment that starts at segmentStart and runs to the end of the path, or drops it (and
+    // the separator before it) if nothing is left of it. Returns whether it was kept.
+    bool CodePushEntryPath::EndSegment(size_t segmentStart)
+    {
+        auto trimmedLength = [this, segmentStart](size_t end) {
+            auto const* data{ Data() };
+            while (end > segmentStart && (data[end - 1] == L'.' || data[end - 1] == L' ')) end--;
+            return end;
+        };
+        auto drop = [this, segmentStart]() {
+            Truncate(segmentStart > 0 ? segmentStart - 1 : 0);
+            return false;
+        };
+
+        // Trailing dots and spaces, which also leaves nothing of "." and ".."
+        Truncate(trimmedLength(m_length));
+        if (m_length == segmentStart)
+        {
+            return drop();
+        }
+
+        // Reserved device names are reserved with any extension
+        const std::wstring_view segment{ Data() + segmentStart, m_length - segmentStart };
+        const auto extension{ segment.rfind(L'.') };
+        if (IsReservedDeviceName(extension == std::wstring_view::npos ? segment : segment.substr(0, extension)))
+        {
+            Append(L'_');
+            auto* data{ Data() };
+            std::copy_backward(data + segmentStart, data + m_length - 1, data + m_length);
+            data[segmentStart] = L'_';
+        }
+
+        if (m_length - segmentStart > MaxSegmentLength)
+        {
+            Truncate(trimmedLength(segmentStart + MaxSegmentLength));
+            if (m_length == segmentStart)
+            {
+                return drop();
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * The relative path a zip entry is written to, built from its UTF-8 name in one pass: the name is
+	 * decoded to UTF-16 (invalid sequences become U+FFFD, as MultiByteToWideChar makes them) and split
+	 * on '/' and '\', and each segment is sanitized as it is decoded. Characters Windows doesn't allow
+	 * in names become '_', trailing dots and spaces are dropped, reserved device names (CON, NUL.txt...)
+	 * get a '_' prefix, and segments are clamped to MaxSegmentLength. Segments left empty (including
+	 * "." and "..") are skipped, so the path can't leave the folder it is written under.
+	 *
+	 * The result lives in an inline buffer, so parsing a name doesn't allocate unless the path is longer
+	 * than InlineCapacity.
+	 */
+	class CodePushEntryPath
+	{
+	public:
+		static constexpr size_t InlineCapacity{ 260 };
+		static constexpr size_t MaxSegmentLength{ 240 };
+
+		// Returns false if the name has no file name left once sanitized (e.g. it ends with a separator).
+		bool Parse(std::string_view name);
+
+		// The sanitized segments joined with '\'.
+		std::wstring_view Path() const noexcept { return { Data(), m_length }; }
+
+		// The path without its first count segments.
+		std::wstring_view PathWithoutSegments(size_t count) const noexcept;
+
+		// The last segment.
+		std::wstring_view FileName() const noexcept;
+
+	private:
+		wchar_t m_inline[InlineCapacity];
+		std::wstring m_overflow; // holds the path instead of m_inline once it is longer
+		size_t m_length{ 0 };
+		bool m_overflowed{ false };
+
+		wchar_t* Data() noexcept { return m_overflowed ? m_overflow.data() : m_inline; }
+		wchar_t const* Data() const noexcept { return m_overflowed ? m_overflow.data() : m_inline; }
+		void Append(wchar_t ch);
+		void Truncate(size_t length) noexcept;
+		bool EndSegment(size_t segmentStart);
+	};
+}
@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Built without the precompiled header: thread priorities and error logging go through CodePushExecutorPlatform.h,
+// so the scheduler itself is also built and tested by windows\CodePushTests.
+#include "CodePushExecutor.h"
+#include "CodePushExecutorPlatform.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    // The priority of the work the calling worker is running, or null on other threads
+    static thread_local CodePushPriority const* t_runningPriority{ nullptr };
+
+    /*static*/ CodePushExecutor& CodePushExecutor::Current()
+    {
+        // Half the cores, so that the UI and JS threads keep the rest. Never destroyed, since its workers run
+        // until the process exits.
+        static auto s_executor{ new CodePushExecutor((std::clamp)(std::thread::hardware_concurrency() / 2, 1u, MaxWorkerCount)) };
+        return *s_executor;
+    }
+
+    CodePushExecutor::CodePushExecutor(unsigned workerCount)
+    {
+        for (unsigned i{ 0 }; i < workerCount; i++)
+        {
+            std::thread{ [this]() { RunWorker(); } }.detach();
+        }
+    }
+
+    void CodePushExecutor::Post(CodePushPriority priority, std::function<void()> task)
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_queues[static_cast<size_t>(priority)].push_back({ std::move(task), std::chrono::steady_clock::now() });
+        }
+        m_wake.notify_one();
+    }
+
+    /*static*/ bool CodePushExecutor::IsRunning(CodePushPriority priority) noexcept
+    {
+        return t_runningPriority != nullptr && *t_runningPriority == priority;
+    }
+
+    void CodePushExecutor::RunWorker()
+    {
+        auto priority{ CodePushPriority::Critical };
+        for (;;)
+        {
+            Task task;
+            {
+                std::unique_lock lock{ m_mutex };
+                m_wake.wait(lock, [this]() {
+                    return std::any_of(m_queues.begin(), m_queues.end(), [](auto const& queue) { return !queue.empty(); });
+                });
+
+                const auto queue{ NextQueue(std::chrono::steady_clock::now()) };
+                task = std::move(m_queues[queue].front());
+                m_queues[queue].pop_front();
+
+                ApplyWorkerPriority(priority, static_cast<CodePushPriority>(queue));
+                priority = static_cast<CodePushPriority>(queue);
+            }
+
+            t_runningPriority = &priority;
+            try
+            {
+                task.run();
+            }
+            catch (...)
+            {
+                LogUnhandledWorkerError();
+            }
+            t_runningPriority = nullptr;
+        }
+    }
+
+    // The highest priority queue with work, unless a lower one's oldest work has waited StarvationLimit
+    // (the longest-waiting such work goes first). Called with m_mutex held.
+    size_t CodePushExecutor::NextQueue(std::chrono::steady_clock::time_point now) const
+    {
+        size_t next{ 0 };
+        while (m_queues[next].empty())
+        {
+            next++;
+        }
+
+        for (auto queue{ next + 1 }; queue < m_queues.size(); queue++)
+        {
+            if (!m_queues[queue].empty() &&
+                now - m_queues[queue].front().queued >= StarvationLimit &&
+                m_queues[queue].front().queued < m_queues[next].front().queued)
+            {
+                next = queue;
+            }
+        }
+        return next;
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	enum class CodePushPriority : uint8_t
+	{
+		Critical, // resolving what to load at startup, and answering JS while it starts
+		Normal, // downloading and installing updates
+		Idle, // prefetching and cleaning up
+	};
+
+	/*
+	 * A fixed set of worker threads that CodePush work is scheduled on, so that inflating, hashing and
+	 * copying don't run on the threads the UI and JS depend on, and so that startup isn't queued behind
+	 * an install. Each stage starts with `co_await CodePushExecutor::Ensure(priority)`, and moves back
+	 * after awaits that complete elsewhere.
+	 *
+	 * Queued work runs highest priority first, in order within a priority, except that work which has
+	 * waited StarvationLimit runs ahead of higher priorities. Workers run Normal work below normal thread
+	 * priority, and Idle work in background mode (lower CPU and I/O priority).
+	 */
+	class CodePushExecutor
+	{
+	public:
+		static constexpr unsigned MaxWorkerCount{ 4 };
+		static constexpr std::chrono::milliseconds StarvationLimit{ 500 };
+
+		static CodePushExecutor& Current();
+
+		// The module only uses Current(); other instances are for tests. Workers run until the process exits,
+		// so an instance must never be destroyed.
+		explicit CodePushExecutor(unsigned workerCount);
+
+		void Post(CodePushPriority priority, std::function<void()> task);
+
+		// Whether the calling thread is a worker running work of the given priority.
+		static bool IsRunning(CodePushPriority priority) noexcept;
+
+		template <bool AlwaysQueue>
+		struct Awaiter
+		{
+			CodePushPriority priority;
+
+			bool await_ready() const noexcept
+			{
+				return !AlwaysQueue && IsRunning(priority);
+			}
+
+			template <typename Handle>
+			void await_suspend(Handle handle) const
+			{
+				Current().Post(priority, [handle]() { handle(); });
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		// Resumes the coroutine on a worker at priority, unless it is already running on one there.
+		static Awaiter<false> Ensure(CodePushPriority priority) noexcept { return { priority }; }
+
+		// Always queues the coroutine, so that a caller on a worker carries on meanwhile (as resume_background does).
+		static Awaiter<true> Resume(CodePushPriority priority) noexcept { return { priority }; }
+
+	private:
+		struct Task
+		{
+			std::function<void()> run;
+			std::chrono::steady_clock::time_point queued;
+		};
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::array<std::deque<Task>, 3> m_queues;
+
+		void RunWorker();
+		size_t NextQueue(std::chrono::steady_clock::time_point now) const;
+	};
+}
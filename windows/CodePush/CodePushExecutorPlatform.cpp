@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushExecutorPlatform.h"
+#include "CodePushUtils.h"
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+
+    void ApplyWorkerPriority(CodePushPriority from, CodePushPriority to) noexcept
+    {
+        if (from == to)
+        {
+            return;
+        }
+        if (from == CodePushPriority::Idle)
+        {
+            ::SetThreadPriority(::GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+        }
+        switch (to)
+        {
+        case CodePushPriority::Critical:
+            ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+            break;
+        case CodePushPriority::Normal:
+            ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+            break;
+        case CodePushPriority::Idle:
+            ::SetThreadPriority(::GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+            break;
+        }
+    }
+
+    void LogUnhandledWorkerError() noexcept
+    {
+        try
+        {
+            throw;
+        }
+        catch (hresult_error const& ex)
+        {
+            CodePushUtils::Log(L"[CodePush] Unhandled error in background work: " + ex.message());
+        }
+        catch (...)
+        {
+            CodePushUtils::Log(L"[CodePush] Unhandled error in background work.");
+        }
+    }
+}
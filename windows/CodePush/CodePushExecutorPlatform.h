@@ -0,0 +1,18 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "CodePushExecutor.h"
+
+namespace Microsoft::CodePush::ReactNative
+{
+	// What CodePushExecutor needs from the platform. The module implements these with Win32 calls; the
+	// portable tests in windows\CodePushTests provide their own, so that the scheduler runs anywhere.
+
+	// Sets the calling worker's thread priority for work of priority to, after work of priority from.
+	void ApplyWorkerPriority(CodePushPriority from, CodePushPriority to) noexcept;
+
+	// Logs the exception that escaped a task. Called from the catch block, so that it can rethrow it.
+	void LogUnhandledWorkerError() noexcept;
+}
@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushExtractionJournal.h"
+#include "CodePushUtils.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+    using namespace Windows::Data::Json;
+
+    static_assert(std::is_trivially_copyable_v<CodePushExtractionJournal::InflateCheckpoint>, "Checkpoints are read and written as raw bytes.");
+
+    // When the system last started, in seconds since 1601. Unflushed journal writes don't survive a restart.
+    static int64_t GetBootTime() noexcept
+    {
+        FILETIME now{};
+        ::GetSystemTimeAsFileTime(&now);
+        const auto nowSeconds{ static_cast<int64_t>(((static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime) / 10000000) };
+        return nowSeconds - static_cast<int64_t>(::GetTickCount64() / 1000);
+    }
+
+    bool CodePushExtractionJournal::Open(std::wstring path, uint64_t archiveLength, uint32_t archiveTag) noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            m_path = std::move(path);
+            m_header = { Signature, FormatVersion, archiveLength, archiveTag, 0, GetBootTime() };
+            m_completedEntries.clear();
+            m_bundleInfo.clear();
+
+            m_file = file_handle{ ::CreateFile2(m_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, OPEN_ALWAYS, nullptr) };
+            if (!m_file)
+            {
+                return false;
+            }
+
+            if (Load())
+            {
+                CodePushUtils::Log(L"[Unzip] Resuming extraction, entries already extracted: " + to_hstring(m_completedEntries.size()));
+                return true;
+            }
+
+            // No journal yet, or one left by another archive: start over
+            m_completedEntries.clear();
+            m_bundleInfo.clear();
+            ::DeleteFileW(CheckpointPath().c_str());
+
+            LARGE_INTEGER start{};
+            DWORD bytesWritten{ 0 };
+            if (!::SetFilePointerEx(m_file.get(), start, nullptr, FILE_BEGIN) ||
+                !::SetEndOfFile(m_file.get()) ||
+                !::WriteFile(m_file.get(), &m_header, sizeof(Header), &bytesWritten, nullptr) ||
+                bytesWritten != sizeof(Header))
+            {
+                m_file.close();
+                return false;
+            }
+            return true;
+        }
+        catch (...)
+        {
+            m_file.close();
+            return false;
+        }
+    }
+
+    bool CodePushExtractionJournal::IsEntryComplete(uint32_t entryIndex) const noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_completedEntries.find(entryIndex) != m_completedEntries.end();
+    }
+
+    void CodePushExtractionJournal::RecordEntry(uint32_t entryIndex) noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            if (m_file && m_completedEntries.insert(entryIndex).second)
+            {
+                Append({ EntryRecord, entryIndex });
+            }
+        }
+        catch (...) {}
+    }
+
+    JsonObject CodePushExtractionJournal::BundleInfo() const noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            JsonObject bundleInfo;
+            if (!m_bundleInfo.empty() && JsonObject::TryParse(m_bundleInfo, bundleInfo))
+            {
+                return bundleInfo;
+            }
+        }
+        catch (...) {}
+        return nullptr;
+    }
+
+    void CodePushExtractionJournal::RecordBundleInfo(JsonObject const& bundleInfo) noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            if (m_file)
+            {
+                m_bundleInfo = bundleInfo.Stringify();
+                Append({ BundleInfoRecord, static_cast<uint32_t>(m_bundleInfo.size() * sizeof(wchar_t)) }, m_bundleInfo.data());
+            }
+        }
+        catch (...) {}
+    }
+
+    bool CodePushExtractionJournal::TryLoadCheckpoint(uint32_t entryIndex, InflateCheckpoint& checkpoint) const noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            if (!m_file)
+            {
+                return false;
+            }
+
+            file_handle file{ ::CreateFile2(CheckpointPath().c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr) };
+            if (!file)
+            {
+                return false;
+            }
+
+            Header header{};
+            DWORD bytesRead{ 0 };
+            if (!::ReadFile(file.get(), &header, sizeof(Header), &bytesRead, nullptr) || bytesRead != sizeof(Header) || !Matches(header))
+            {
+                return false;
+            }
+
+            return ::ReadFile(file.get(), &checkpoint, sizeof(InflateCheckpoint), &bytesRead, nullptr) &&
+                bytesRead == sizeof(InflateCheckpoint) &&
+                checkpoint.entryIndex == entryIndex &&
+                checkpoint.dictionaryOffset < TINFL_LZ_DICT_SIZE;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    void CodePushExtractionJournal::SaveCheckpoint(InflateCheckpoint const& checkpoint) noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            if (!m_file)
+            {
+                return;
+            }
+
+            // Written aside and renamed, so a kill while saving leaves the previous checkpoint intact
+            auto const checkpointPath{ CheckpointPath() };
+            auto const tempPath{ checkpointPath + L".tmp" };
+            {
+                file_handle file{ ::CreateFile2(tempPath.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr) };
+                DWORD bytesWritten{ 0 };
+                if (!file ||
+                    !::WriteFile(file.get(), &m_header, sizeof(Header), &bytesWritten, nullptr) ||
+                    !::WriteFile(file.get(), &checkpoint, sizeof(InflateCheckpoint), &bytesWritten, nullptr) ||
+                    bytesWritten != sizeof(InflateCheckpoint))
+                {
+                    return;
+                }
+            }
+            ::MoveFileExW(tempPath.c_str(), checkpointPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+        }
+        catch (...) {}
+    }
+
+    void CodePushExtractionJournal::DiscardCheckpoint() noexcept
+    {
+        std::lock_guard lock{ m_mutex };
+        try
+        {
+            ::DeleteFileW(CheckpointPath().c_str());
+        }
+        catch (...) {}
+    }
+
+    /*static*/ void CodePushExtractionJournal::Delete(std::wstring const& path) noexcept
+    {
+        try
+        {
+            ::DeleteFileW((path + L".ckpt").c_str());
+            ::DeleteFileW(path.c_str());
+        }
+        catch (...) {}
+    }
+
+    bool CodePushExtractionJournal::Matches(Header const& header) const noexcept
+    {
+        constexpr int64_t bootTimeTolerance{ 60 };
+        return header.signature == m_header.signature &&
+            header.version == m_header.version &&
+            header.archiveLength == m_header.archiveLength &&
+            header.archiveTag == m_header.archiveTag &&
+            header.bootTime > m_header.bootTime - bootTimeTolerance &&
+            header.bootTime < m_header.bootTime + bootTimeTolerance;
+    }
+
+    bool CodePushExtractionJournal::Load()
+    {
+        Header header{};
+        DWORD bytesRead{ 0 };
+        if (!::ReadFile(m_file.get(), &header, sizeof(Header), &bytesRead, nullptr) || bytesRead != sizeof(Header) || !Matches(header))
+        {
+            return false;
+        }
+
+        // Keep the records up to the first incomplete one, which is where the previous run was killed
+        LARGE_INTEGER validLength{};
+        validLength.QuadPart = sizeof(Header);
+        Record record{};
+        while (::ReadFile(m_file.get(), &record, sizeof(Record), &bytesRead, nullptr) && bytesRead == sizeof(Record))
+        {
+            if (record.type == EntryRecord)
+            {
+                m_completedEntries.insert(record.value);
+                validLength.QuadPart += sizeof(Record);
+            }
+            else if (record.type == BundleInfoRecord && record.value % sizeof(wchar_t) == 0)
+            {
+                std::wstring bundleInfo(record.value / sizeof(wchar_t), L'\0');
+                if (!::ReadFile(m_file.get(), bundleInfo.data(), record.value, &bytesRead, nullptr) || bytesRead != record.value)
+                {
+                    break;
+                }
+                m_bundleInfo = std::move(bundleInfo);
+                validLength.QuadPart += sizeof(Record) + record.value;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return ::SetFilePointerEx(m_file.get(), validLength, nullptr, FILE_BEGIN) && ::SetEndOfFile(m_file.get());
+    }
+
+    bool CodePushExtractionJournal::Append(Record const& record, void const* payload) noexcept
+    {
+        DWORD bytesWritten{ 0 };
+        if (!::WriteFile(m_file.get(), &record, sizeof(Record), &bytesWritten, nullptr) || bytesWritten != sizeof(Record))
+        {
+            return false;
+        }
+        return payload == nullptr ||
+            (::WriteFile(m_file.get(), payload, record.value, &bytesWritten, nullptr) && bytesWritten == record.value);
+    }
+}
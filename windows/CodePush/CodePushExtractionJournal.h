@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "winrt/Windows.Data.Json.h"
+
+#include "miniz/miniz.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * Append-only record of an extraction in progress, so that an extraction interrupted by the app
+	 * being killed resumes where it left off instead of starting over. A journal belongs to one
+	 * archive, identified by its length and a CRC-32 of its trailing bytes (which hold the central
+	 * directory, and with it every entry's CRC); opening it for another archive discards it.
+	 *
+	 * An entry is recorded once its file has been written in full. Large deflated entries also save
+	 * an inflate checkpoint next to the journal every CheckpointIntervalBytes of output. Neither is
+	 * flushed to disk, so a journal written before the system restarted is discarded.
+	 */
+	struct CodePushExtractionJournal
+	{
+		static constexpr uint64_t CheckpointIntervalBytes{ 8 * 1024 * 1024 };
+
+		// Everything needed to continue inflating an entry: the inflater (including its bit buffer),
+		// its 32 KB window and how far both the compressed input and the output file have got.
+		struct InflateCheckpoint
+		{
+			uint32_t entryIndex;
+			uint32_t crc32; // of the first outputOffset bytes
+			uint64_t inputOffset;
+			uint64_t outputOffset;
+			uint32_t dictionaryOffset;
+			tinfl_decompressor decompressor;
+			uint8_t dictionary[TINFL_LZ_DICT_SIZE];
+		};
+
+		CodePushExtractionJournal() = default;
+		CodePushExtractionJournal(CodePushExtractionJournal const&) = delete;
+		CodePushExtractionJournal& operator=(CodePushExtractionJournal const&) = delete;
+
+		// Opens the journal at path, keeping what it recorded if it belongs to the same archive.
+		// Returns false if the journal can't be written, in which case nothing is recorded.
+		bool Open(std::wstring path, uint64_t archiveLength, uint32_t archiveTag) noexcept;
+
+		bool IsEntryComplete(uint32_t entryIndex) const noexcept;
+		void RecordEntry(uint32_t entryIndex) noexcept;
+
+		// The bundle description returned by FileUtils::UnzipAsync, kept for when its entry is skipped.
+		winrt::Windows::Data::Json::JsonObject BundleInfo() const noexcept;
+		void RecordBundleInfo(winrt::Windows::Data::Json::JsonObject const& bundleInfo) noexcept;
+
+		bool TryLoadCheckpoint(uint32_t entryIndex, InflateCheckpoint& checkpoint) const noexcept;
+		void SaveCheckpoint(InflateCheckpoint const& checkpoint) noexcept;
+		void DiscardCheckpoint() noexcept;
+
+		// Deletes the journal at path and its checkpoint.
+		static void Delete(std::wstring const& path) noexcept;
+
+	private:
+		static constexpr uint32_t Signature{ 0x4A585043 }; // "CPXJ"
+		static constexpr uint32_t FormatVersion{ 1 };
+
+		enum RecordType : uint32_t
+		{
+			EntryRecord = 1,
+			BundleInfoRecord = 2,
+		};
+
+		struct Header
+		{
+			uint32_t signature;
+			uint32_t version;
+			uint64_t archiveLength;
+			uint32_t archiveTag;
+			uint32_t reserved;
+			int64_t bootTime; // seconds since 1601, only compared roughly
+		};
+
+		struct Record
+		{
+			uint32_t type;
+			uint32_t value; // entry index, or the byte length of the payload that follows
+		};
+
+		mutable std::mutex m_mutex;
+		winrt::file_handle m_file;
+		std::wstring m_path;
+		Header m_header{};
+		std::unordered_set<uint32_t> m_completedEntries;
+		std::wstring m_bundleInfo;
+
+		bool Matches(Header const& header) const noexcept;
+		bool Load();
+		bool Append(Record const& record, void const* payload = nullptr) noexcept;
+		std::wstring CheckpointPath() const { return m_path + L".ckpt"; }
+	};
+}
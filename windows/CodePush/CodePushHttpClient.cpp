@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "winrt/Windows.Foundation.h"
+#include "winrt/Windows.Storage.Streams.h"
+#include "winrt/Windows.System.Threading.h"
+#include "winrt/Windows.Web.Http.h"
+#include "winrt/Windows.Web.Http.Filters.h"
+
+#include "CodePushConfig.h"
+#include "CodePushHttpClient.h"
+
+#include <atomic>
+#include <memory>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+    using namespace Windows::Foundation;
+    using namespace Windows::Storage::Streams;
+    using namespace Windows::System::Threading;
+    using namespace Windows::Web::Http;
+    using namespace Windows::Web::Http::Filters;
+
+    // Cancels the operation once the timeout elapses, and reports that as ERROR_TIMEOUT rather than as a cancellation.
+    // A timeout of zero waits for as long as the operation takes.
+    template <typename TResult, typename TOperation>
+    static IAsyncOperation<TResult> WithTimeoutAsync(TOperation operation, TimeSpan timeout, hstring what)
+    {
+        auto cancellation{ co_await get_cancellation_token() };
+        cancellation.enable_propagation();
+
+        if (timeout.count() <= 0)
+        {
+            co_return co_await operation;
+        }
+
+        auto timedOut{ std::make_shared<std::atomic<bool>>(false) };
+        auto timer{ ThreadPoolTimer::CreateTimer([operation, timedOut](ThreadPoolTimer const&)
+            {
+                *timedOut = true;
+                operation.Cancel();
+            }, timeout) };
+
+        TResult result{ nullptr };
+        try
+        {
+            result = co_await operation;
+        }
+        catch (hresult_canceled const&)
+        {
+            if (!*timedOut)
+            {
+                throw;
+            }
+        }
+        timer.Cancel();
+
+        if (*timedOut && result == nullptr)
+        {
+            throw hresult_error(HRESULT_FROM_WIN32(ERROR_TIMEOUT), what + L" timed out.");
+        }
+        co_return result;
+    }
+
+    /*static*/ HttpClient CodePushHttpClient::Shared()
+    {
+        static HttpClient s_client{ []()
+            {
+                HttpBaseProtocolFilter filter;
+                filter.MaxVersion(HttpVersion::Http20);
+
+                // Downloads decode compressed responses themselves, so that progress can count the bytes received
+                filter.AutomaticDecompression(false);
+
+                // Update checks have to reach the server, and a resumed download mustn't be answered from a cached response
+                filter.CacheControl().ReadBehavior(HttpCacheReadBehavior::NoCache);
+                filter.CacheControl().WriteBehavior(HttpCacheWriteBehavior::NoCache);
+                return HttpClient{ filter };
+            }() };
+        return s_client;
+    }
+
+    /*static*/ IAsyncOperation<HttpResponseMessage> CodePushHttpClient::SendRequestAsync(HttpRequestMessage request, HttpCompletionOption completionOption)
+    {
+        auto cancellation{ co_await get_cancellation_token() };
+        cancellation.enable_propagation();
+
+        auto uri{ request.RequestUri().AbsoluteUri() };
+        co_return co_await WithTimeoutAsync<HttpResponseMessage>(
+            Shared().SendRequestAsync(request, completionOption),
+            CodePushConfig::Current().GetHttpRequestTimeout(),
+            L"Request to " + uri);
+    }
+
+    /*static*/ IAsyncOperation<IBuffer> CodePushHttpClient::ReadAsync(IInputStream inputStream, IBuffer buffer, uint32_t count)
+    {
+        auto cancellation{ co_await get_cancellation_token() };
+        cancellation.enable_propagation();
+
+        co_return co_await WithTimeoutAsync<IBuffer>(
+            inputStream.ReadAsync(buffer, count, InputStreamOptions::None),
+            CodePushConfig::Current().GetHttpReadTimeout(),
+            L"Reading the response");
+    }
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "winrt/Windows.Foundation.h"
+#include "winrt/Windows.Storage.Streams.h"
+#include "winrt/Windows.Web.Http.h"
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * The HTTP client every CodePush request goes through: update checks, status reports and
+	 * package downloads. They share one HttpClient, so a download that follows a check reuses its
+	 * connection, and TLS session, instead of opening a new one; requests to the same server are
+	 * multiplexed over HTTP/2 where the server supports it.
+	 *
+	 * Timeouts come from CodePushConfig (httpRequestTimeout and httpReadTimeout, in milliseconds).
+	 * Cancelling one of these operations cancels the underlying request or read.
+	 */
+	struct CodePushHttpClient
+	{
+		static winrt::Windows::Web::Http::HttpClient Shared();
+
+		// Sends the request, failing with ERROR_TIMEOUT if the response (or its headers, depending on
+		// completionOption) doesn't arrive within the request timeout.
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Web::Http::HttpResponseMessage> SendRequestAsync(
+			winrt::Windows::Web::Http::HttpRequestMessage request,
+			winrt::Windows::Web::Http::HttpCompletionOption completionOption);
+
+		// Reads from a response stream, failing with ERROR_TIMEOUT if no data arrives within the read timeout.
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::Streams::IBuffer> ReadAsync(
+			winrt::Windows::Storage::Streams::IInputStream inputStream,
+			winrt::Windows::Storage::Streams::IBuffer buffer,
+			uint32_t count);
+	};
+}
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushInstallReservation.h"
+#include "CodePushUtils.h"
+
+#include <algorithm>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+
+    CodePushInstallReservation::CodePushInstallReservation(std::wstring path, uint64_t budgetBytes) noexcept :
+        m_path{ std::move(path) }, m_budgetBytes{ budgetBytes } {}
+
+    void CodePushInstallReservation::Reserve(CodePushInstallPlan const& plan)
+    {
+        Close();
+        m_plan = plan;
+
+        const auto required{ plan.RequiredBytes() };
+        if (m_budgetBytes > 0 && required > m_budgetBytes)
+        {
+            throw hresult_error(HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE),
+                L"Installing the update needs " + to_hstring(required) + L" bytes, over the install budget of " + to_hstring(m_budgetBytes) + L" bytes.");
+        }
+
+        const auto freeBytes{ GetFreeBytes(m_path) };
+        if (freeBytes != UINT64_MAX && required + HeadroomBytes > freeBytes)
+        {
+            throw hresult_error(HRESULT_FROM_WIN32(ERROR_DISK_FULL),
+                L"Installing the update needs " + to_hstring(required) + L" bytes, but only " + to_hstring(freeBytes) + L" are free.");
+        }
+
+        if (required < ReleaseStepBytes)
+        {
+            // Too little to be worth holding
+            return;
+        }
+
+        CREATEFILE2_EXTENDED_PARAMETERS parameters{ sizeof(parameters) };
+        parameters.dwFileAttributes = FILE_ATTRIBUTE_TEMPORARY | FILE_ATTRIBUTE_HIDDEN;
+        parameters.dwFileFlags = FILE_FLAG_DELETE_ON_CLOSE;
+        m_file = file_handle{ ::CreateFile2(m_path.c_str(), GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, &parameters) };
+        if (!m_file)
+        {
+            // Without a reservation the install still fits; it just isn't protected from other writers
+            CodePushUtils::Log(L"[CodePush] Could not create the install reservation (" + to_hstring(static_cast<int32_t>(::GetLastError())) + L").");
+            return;
+        }
+
+        if (!SetAllocation(required))
+        {
+            const auto error{ ::GetLastError() };
+            m_file.close();
+            if (error == ERROR_DISK_FULL)
+            {
+                // The free space was taken, or is held back by a quota
+                throw hresult_error(HRESULT_FROM_WIN32(ERROR_DISK_FULL),
+                    L"Installing the update needs " + to_hstring(required) + L" bytes, which the disk can't hold.");
+            }
+            CodePushUtils::Log(L"[CodePush] Could not reserve space for the install (" + to_hstring(static_cast<int32_t>(error)) + L").");
+            return;
+        }
+        m_reservedBytes = required;
+    }
+
+    void CodePushInstallReservation::Release(uint64_t bytes) noexcept
+    {
+        if (!m_file)
+        {
+            return;
+        }
+
+        m_releasedBytes += bytes;
+        if (m_releasedBytes <= m_freedBytes)
+        {
+            return;
+        }
+
+        // Free a step ahead, so that the writes in between have room without shrinking the file for each of them
+        const auto freedBytes{ (std::min)(m_reservedBytes, m_releasedBytes + ReleaseStepBytes) };
+        if (freedBytes == m_reservedBytes || !SetAllocation(m_reservedBytes - freedBytes))
+        {
+            Close();
+            return;
+        }
+        m_freedBytes = freedBytes;
+    }
+
+    void CodePushInstallReservation::Close() noexcept
+    {
+        // The file is deleted on close, which frees whatever it still holds
+        m_file.close();
+        m_reservedBytes = 0;
+        m_releasedBytes = 0;
+        m_freedBytes = 0;
+    }
+
+    /*static*/ uint64_t CodePushInstallReservation::GetFreeBytes(std::wstring const& path) noexcept
+    {
+        ULARGE_INTEGER freeBytes{};
+        if (::GetDiskFreeSpaceExW(path.c_str(), &freeBytes, nullptr, nullptr))
+        {
+            return freeBytes.QuadPart;
+        }
+
+        // A file, or one that doesn't exist yet: ask about its folder
+        const auto separator{ path.find_last_of(L"\\/") };
+        if (separator != std::wstring::npos &&
+            ::GetDiskFreeSpaceExW(path.substr(0, separator + 1).c_str(), &freeBytes, nullptr, nullptr))
+        {
+            return freeBytes.QuadPart;
+        }
+        return UINT64_MAX;
+    }
+
+    bool CodePushInstallReservation::SetAllocation(uint64_t bytes) noexcept
+    {
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(bytes);
+        return ::SetFileInformationByHandle(m_file.get(), FileAllocationInfo, &allocation, sizeof(allocation)) != FALSE;
+    }
+}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "winrt/base.h"
+
+#include <cstdint>
+#include <string>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	// What installing an archive is going to write, worked out from its central directory before anything is written
+	struct CodePushInstallPlan
+	{
+		uint64_t contentBytes{ 0 }; // every file in the archive
+		uint64_t extractBytes{ 0 }; // the files still to be extracted (an interrupted extraction has written the others)
+		uint64_t packageBytes{ 0 }; // the new package folder: the extracted files, on top of a copy of the installed package for a diff
+
+		uint64_t RequiredBytes() const { return extractBytes + packageBytes; }
+	};
+
+	/*
+	 * Holds the disk space an install needs, so that an install that can't fit fails before it writes
+	 * anything instead of once the disk is full, and so that nothing else on the volume can take the
+	 * space while the install runs. The space is allocated to a reservation file (deleted when the
+	 * reservation is closed, or with the process), which gives it back as the install writes.
+	 */
+	class CodePushInstallReservation
+	{
+	public:
+		// budgetBytes limits the bytes one install may write; 0 leaves only the free space to limit it.
+		CodePushInstallReservation(std::wstring path, uint64_t budgetBytes) noexcept;
+		CodePushInstallReservation(CodePushInstallReservation const&) = delete;
+		CodePushInstallReservation& operator=(CodePushInstallReservation const&) = delete;
+
+		// Checks the plan against the budget and the free space, and reserves its bytes. Throws hresult_error
+		// with ERROR_FILE_TOO_LARGE if the plan is over budget, or ERROR_DISK_FULL if the volume can't hold it.
+		void Reserve(CodePushInstallPlan const& plan);
+
+		// Gives back the space for bytes about to be written.
+		void Release(uint64_t bytes) noexcept;
+
+		// Gives back whatever is left.
+		void Close() noexcept;
+
+		CodePushInstallPlan const& Plan() const noexcept { return m_plan; }
+
+		// The free space on the volume that holds path (a file or a folder), or UINT64_MAX if it can't be found.
+		static uint64_t GetFreeBytes(std::wstring const& path) noexcept;
+
+	private:
+		// Space is given back in steps of at least this, rather than for every file
+		static constexpr uint64_t ReleaseStepBytes{ 16 * 1024 * 1024 };
+		// Free space that has to be left over once the install is done
+		static constexpr uint64_t HeadroomBytes{ 32 * 1024 * 1024 };
+
+		std::wstring m_path;
+		uint64_t m_budgetBytes;
+		CodePushInstallPlan m_plan;
+		winrt::file_handle m_file;
+		uint64_t m_reservedBytes{ 0 };
+		uint64_t m_releasedBytes{ 0 }; // requested through Release
+		uint64_t m_freedBytes{ 0 }; // actually given back, a step ahead of m_releasedBytes
+
+		bool SetAllocation(uint64_t bytes) noexcept;
+	};
+}
@@ -7,10 +7,16 @@
 #include "CodePushUtils.h"
 #include "CodePushUpdateUtils.h"
 #include "CodePushPackage.h"
+#include "CodePushSettingsStore.h"
+#include "CodePushStatusRecord.h"
 #include "CodePushTelemetryManager.h"
 #include "CodePushConfig.h"
+#include "CodePushExecutor.h"
+#include "CodePushHttpClient.h"
 #include "CodePushUtils.h"
+#include "FileUtils.h"
 
+#include <algorithm>
 #include <string_view>
 
 #include "miniz/miniz.h"
@@ -18,6 +24,9 @@
 #include "winrt/Windows.ApplicationModel.h"
 #include "winrt/Windows.Data.Json.h"
 #include "winrt/Windows.Storage.FileProperties.h"
+#include "winrt/Windows.Storage.Streams.h"
+#include "winrt/Windows.Web.Http.h"
+#include "winrt/Windows.Web.Http.Headers.h"
 
 #include "ReactPackageProvider.h"
 
@@ -57,27 +66,72 @@ namespace Microsoft::CodePush::ReactNative
             s_javaScriptBundleFileName = bundleFileName;
         }
 
-        auto packageBundle{ co_await CodePushPackage::GetCurrentPackageBundleAsync() };
         auto binaryBundle{ co_await GetBinaryBundleAsync() };
+        auto binaryAppVersion{ CodePushConfig::Current().GetAppVersion() };
 
-        if (packageBundle == nullptr)
+        StorageFile packageBundle{ nullptr };
+        hstring packageDate;
+        hstring packageAppVersion;
+
+        // Resolve the current package from the binary status record when possible,
+        // which avoids reading and parsing codepush.json and app.json on startup.
+        CodePushStatusRecord record;
+        auto hasRecord{ CodePushStatusRecord::TryLoad(record) };
+        if (!hasRecord)
         {
-            CodePushUtils::LogBundleUrl(binaryBundle);
-            isRunningBinaryVersion = true;
-            co_return binaryBundle;
+            co_await MigrateStatusRecordAsync();
+            hasRecord = CodePushStatusRecord::TryLoad(record);
         }
 
-        auto binaryAppVersion{ CodePushConfig::Current().GetAppVersion() };
-        auto currentPackageMetadata{ co_await CodePushPackage::GetCurrentPackageAsync() };
-        if (currentPackageMetadata == nullptr)
+        if (hasRecord && record.currentPackage.Empty())
         {
             CodePushUtils::LogBundleUrl(binaryBundle);
             isRunningBinaryVersion = true;
             co_return binaryBundle;
         }
 
-        auto packageDate{ currentPackageMetadata.GetNamedString(BinaryBundleDateKey, L"") };
-        auto packageAppVersion{ currentPackageMetadata.GetNamedString(AppVersionKey, L"") };
+        if (hasRecord && !record.bundlePath.Empty())
+        {
+            std::wstring bundlePath{ GetLocalStorageFolder().Path() };
+            bundlePath += L"\\CodePush\\";
+            bundlePath += record.currentPackage.View();
+            bundlePath += L'\\';
+            bundlePath += record.bundlePath.View();
+            std::replace(bundlePath.begin(), bundlePath.end(), L'/', L'\\');
+            try
+            {
+                packageBundle = co_await StorageFile::GetFileFromPathAsync(bundlePath);
+                packageDate = record.binaryDate.View();
+                packageAppVersion = record.appVersion.View();
+            }
+            catch (const hresult_error&)
+            {
+                CodePushUtils::Log(L"Bundle path from the status record is stale, resolving from package metadata.");
+                packageBundle = nullptr;
+            }
+        }
+
+        if (packageBundle == nullptr)
+        {
+            packageBundle = co_await CodePushPackage::GetCurrentPackageBundleAsync();
+            if (packageBundle == nullptr)
+            {
+                CodePushUtils::LogBundleUrl(binaryBundle);
+                isRunningBinaryVersion = true;
+                co_return binaryBundle;
+            }
+
+            auto currentPackageMetadata{ co_await CodePushPackage::GetCurrentPackageAsync() };
+            if (currentPackageMetadata == nullptr)
+            {
+                CodePushUtils::LogBundleUrl(binaryBundle);
+                isRunningBinaryVersion = true;
+                co_return binaryBundle;
+            }
+
+            packageDate = currentPackageMetadata.GetNamedString(BinaryBundleDateKey, L"");
+            packageAppVersion = currentPackageMetadata.GetNamedString(AppVersionKey, L"");
+        }
 
         if ((co_await CodePushUpdateUtils::ModifiedDateStringOfFileAsync(binaryBundle)) == packageDate && binaryAppVersion == packageAppVersion)
         {
@@ -143,36 +197,31 @@ namespace Microsoft::CodePush::ReactNative
      */
     bool CodePushNativeModule::IsFailedHash(std::wstring_view packageHash) 
     { 
-        auto localSettings{ GetLocalSettings() };
-        auto failedUpdatesData{ localSettings.Values().TryLookup(FailedUpdatesKey) };
-        if (failedUpdatesData == nullptr)
+        CodePushStatusRecord record;
+        if (CodePushStatusRecord::TryLoad(record) && !record.HasFlag(CodePushStatusRecord::FailedHashesOverflow))
         {
-            return false;
+            return !packageHash.empty() && record.IsFailedHash(packageHash);
         }
-        auto failedUpdatesString{ unbox_value<hstring>(failedUpdatesData) };
-        JsonArray failedUpdates;
-        auto success{ JsonArray::TryParse(failedUpdatesString, failedUpdates) };
-        if (!success || packageHash.empty())
+
+        if (packageHash.empty())
         {
             return false;
         }
-        else
+
+        for (const auto& failedPackage : CodePushSettingsStore::Current().GetFailedUpdates())
         {
-            for (const auto& failedPackage : failedUpdates)
+            // We don't have to worry about backwards compatability, but just to be safe...
+            if (failedPackage.ValueType() == JsonValueType::Object)
             {
-                // We don't have to worry about backwards compatability, but just to be safe...
-                if (failedPackage.ValueType() == JsonValueType::Object)
+                auto failedPackageHash{ failedPackage.GetObject().GetNamedString(PackageHashKey) };
+                if (packageHash == failedPackageHash)
                 {
-                    auto failedPackageHash{ failedPackage.GetObject().GetNamedString(PackageHashKey) };
-                    if (packageHash == failedPackageHash)
-                    {
-                        return true;
-                    }
+                    return true;
                 }
             }
-
-            return false;
         }
+
+        return false;
     }
 
     /*
@@ -204,24 +253,23 @@ namespace Microsoft::CodePush::ReactNative
      */
     /*static*/ bool CodePushNativeModule::IsPendingUpdate(std::wstring_view packageHash)
     { 
-        auto localSettings{ GetLocalSettings() };
-        auto pendingUpdateData{ localSettings.Values().TryLookup(PendingUpdateKey) };
-        if (pendingUpdateData != nullptr)
-        {
-            auto pendingUpdateString{ unbox_value<hstring>(pendingUpdateData) };
-            JsonObject pendingUpdate;
-            auto success{ JsonObject::TryParse(pendingUpdateString, pendingUpdate) };
-        
-            // If there is a pending update whose "state" isn't loading, then we consider it "pending".
-            // Additionally, if a specific hash was provided, we ensure it matches that of the pending update.
-            auto updateIsPending{ success &&
-                pendingUpdate != nullptr &&
-                pendingUpdate.GetNamedBoolean(PendingUpdateIsLoadingKey, false) == false &&
-                (packageHash.empty() || pendingUpdate.GetNamedString(PendingUpdateHashKey, L"null") == packageHash) };
-
-            return updateIsPending;
+        CodePushStatusRecord record;
+        if (CodePushStatusRecord::TryLoad(record))
+        {
+            return record.HasFlag(CodePushStatusRecord::HasPendingUpdate) &&
+                !record.HasFlag(CodePushStatusRecord::PendingUpdateIsLoading) &&
+                (packageHash.empty() || record.pendingPackage.View() == packageHash);
         }
-        return false;
+
+        auto pendingUpdate{ CodePushSettingsStore::Current().GetPendingUpdate() };
+
+        // If there is a pending update whose "state" isn't loading, then we consider it "pending".
+        // Additionally, if a specific hash was provided, we ensure it matches that of the pending update.
+        auto updateIsPending{ pendingUpdate != nullptr &&
+            pendingUpdate.GetNamedBoolean(CodePushSettingsStore::PendingUpdateIsLoadingKey, false) == false &&
+            (packageHash.empty() || pendingUpdate.GetNamedString(CodePushSettingsStore::PendingUpdateHashKey, L"null") == packageHash) };
+
+        return updateIsPending;
     }
 
     /*
@@ -233,6 +281,7 @@ namespace Microsoft::CodePush::ReactNative
     IAsyncAction CodePushNativeModule::ClearDebugUpdates()
     {
     #ifndef BUNDLE
+        co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
         auto binaryAppVersion{ CodePushConfig::Current().GetAppVersion() };
         auto currentPackageMetadata{ co_await CodePushPackage::GetCurrentPackageAsync() };
         if (currentPackageMetadata != nullptr)
@@ -250,10 +299,33 @@ namespace Microsoft::CodePush::ReactNative
     /*static*/ IAsyncAction CodePushNativeModule::ClearUpdatesStaticAsync()
     {
         co_await CodePushPackage::ClearUpdatesAsync();
+
+        CodePushSettingsTransaction transaction;
         RemovePendingUpdate();
         RemoveFailedUpdates();
     }
 
+    /*
+     * This method builds the binary status record from the settings store,
+     * codepush.json and app.json. It runs once after upgrading
+     * from a version without the record, or whenever the record was invalidated.
+     */
+    /*static*/ IAsyncAction CodePushNativeModule::MigrateStatusRecordAsync()
+    {
+        CodePushStatusRecord record;
+        record.Reset();
+        if (!CodePushStatusRecord::Save(record))
+        {
+            CodePushUtils::Log(L"Unable to create the status record, using JSON state.");
+            co_return;
+        }
+
+        CodePushSettingsStore::Current().UpdateStatusRecord();
+
+        // Fill in the package fields from codepush.json and app.json.
+        co_await CodePushPackage::UpdateStatusRecordAsync();
+    }
+
     void CodePushNativeModule::DispatchDownloadProgressEvent()
     {
         // Notify the script-side about the progress
@@ -270,12 +342,15 @@ namespace Microsoft::CodePush::ReactNative
     {
         if (!s_host.InstanceSettings().UseWebDebugger())
         {
+            // Resolve the bundle on a worker, and come back to the caller's thread to hand it to the host
+            apartment_context callerContext;
+            co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
             auto bundleFile{ co_await GetBundleFileAsync() };
+            co_await callerContext;
             if (bundleFile != nullptr)
             {
-                std::wstring_view bundlePath{ bundleFile.Path() };
-                hstring bundleRootPath{ bundlePath.substr(0, bundlePath.rfind('\\')) };
-                s_host.InstanceSettings().BundleRootPath(bundleRootPath);
+                ReloadBundle(bundleFile.Path());
+                co_return;
             }
         }
 
@@ -283,6 +358,29 @@ namespace Microsoft::CodePush::ReactNative
         // The instance will call Initialize() upon reloading this module
     }
 
+    /*static*/ void CodePushNativeModule::ReloadBundle(hstring const& bundlePath)
+    {
+        PrewarmBundle(bundlePath);
+
+        std::wstring_view bundlePathView{ bundlePath };
+        hstring bundleRootPath{ bundlePathView.substr(0, bundlePathView.rfind('\\')) };
+        s_host.InstanceSettings().BundleRootPath(bundleRootPath);
+        s_host.ReloadInstance();
+    }
+
+    /*
+     * This method starts reading the bundle into the file cache in the background
+     * so that the JS engine doesn't pay for a cold read when it loads the bundle.
+     */
+    /*static*/ void CodePushNativeModule::PrewarmBundle(hstring const& bundlePath)
+    {
+        auto budget{ CodePushConfig::Current().GetBundlePrewarmBudget() };
+        if (budget > 0 && !bundlePath.empty())
+        {
+            FileUtils::PrefetchFileAsync(bundlePath, budget);
+        }
+    }
+
     /*
      * This method is used when an update has failed installation
      * and the app needs to be rolled back to the previous bundle.
@@ -292,20 +390,50 @@ namespace Microsoft::CodePush::ReactNative
      */
     IAsyncAction CodePushNativeModule::RollbackPackage()
     {
-        auto failedPackage{ co_await CodePushPackage::GetCurrentPackageAsync() };
-        if (failedPackage == nullptr)
+        co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
+
+        JsonObject failedPackage{ nullptr };
+        CodePushStatusRecord record;
+        if (CodePushStatusRecord::TryLoad(record))
         {
-            CodePushUtils::Log(L"Attempted to perform a rollback when there is no current update.");
+            if (!record.currentPackage.Empty())
+            {
+                failedPackage = co_await CodePushPackage::GetPackageAsync(record.currentPackage.View());
+            }
         }
         else
         {
-            SaveFailedUpdate(failedPackage);
+            failedPackage = co_await CodePushPackage::GetCurrentPackageAsync();
+        }
+
+        if (failedPackage == nullptr)
+        {
+            CodePushUtils::Log(L"Attempted to perform a rollback when there is no current update.");
         }
 
         // Rollback to the previous version and de-register the new update
-        co_await CodePushPackage::RollbackPackage();
-        RemovePendingUpdate();
-        co_await LoadBundle();
+        auto bundlePath{ co_await CodePushPackage::RollbackPackage() };
+        {
+            // Record the failure and clear the pending update with a single settings commit.
+            CodePushSettingsTransaction transaction;
+            if (failedPackage != nullptr)
+            {
+                SaveFailedUpdate(failedPackage);
+            }
+            RemovePendingUpdate();
+        }
+
+        if (bundlePath.empty() || s_host.InstanceSettings().UseWebDebugger())
+        {
+            co_await LoadBundle();
+            co_return;
+        }
+
+        // The previous package was checked against the disk and the binary when it was recorded, so its bundle
+        // is loaded without being resolved again
+        CodePushUtils::Log(L"Loading JS bundle from \"" + bundlePath + L"\"");
+        isRunningBinaryVersion = false;
+        ReloadBundle(bundlePath);
     }
 
     /*
@@ -315,8 +443,7 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ void CodePushNativeModule::RemoveFailedUpdates()
     {
-        auto localSettings{ GetLocalSettings() };
-        localSettings.Values().TryRemove(FailedUpdatesKey);
+        CodePushSettingsStore::Current().RemoveFailedUpdates();
     }
 
     /*
@@ -325,9 +452,7 @@ namespace Microsoft::CodePush::ReactNative
      */
     /*static*/ void CodePushNativeModule::RemovePendingUpdate()
     {
-        // remove pending update from LocalSettings
-        auto localSettings{ GetLocalSettings() };
-        localSettings.Values().TryRemove(PendingUpdateKey);
+        CodePushSettingsStore::Current().RemovePendingUpdate();
     }
 
     IAsyncAction CodePushNativeModule::RestartAppInternal(bool onlyIfUpdateIsPending)
@@ -373,15 +498,7 @@ namespace Microsoft::CodePush::ReactNative
             return;
         }
 
-        auto localSettings{ GetLocalSettings() };
-        auto failedUpdates{ localSettings.Values().TryLookup(FailedUpdatesKey).try_as<JsonArray>() };
-        if (failedUpdates == nullptr)
-        {
-            failedUpdates = JsonArray{};
-        }
-
-        failedUpdates.Append(failedPackage);
-        localSettings.Values().Insert(FailedUpdatesKey, box_value(failedUpdates.Stringify()));
+        CodePushSettingsStore::Current().AddFailedUpdate(failedPackage);
     }
 
     /*
@@ -393,11 +510,7 @@ namespace Microsoft::CodePush::ReactNative
     {
         // Since we're not restarting, we need to store the fact that the update
         // was installed, but hasn't yet become "active".
-        auto localSettings{ GetLocalSettings() };
-        JsonObject pendingUpdate{};
-        pendingUpdate.Insert(PendingUpdateHashKey, JsonValue::CreateStringValue(packageHash));
-        pendingUpdate.Insert(PendingUpdateIsLoadingKey, JsonValue::CreateBooleanValue(isLoading));
-        localSettings.Values().Insert(PendingUpdateKey, box_value(pendingUpdate.Stringify()));
+        CodePushSettingsStore::Current().SetPendingUpdate(packageHash, isLoading);
     }
 
     /*static*/ void CodePushNativeModule::SetHost(const ReactNativeHost& host)
@@ -409,6 +522,7 @@ namespace Microsoft::CodePush::ReactNative
     {
         m_context = reactContext;
         InitializeUpdateAfterRestart();
+        CodePushPackage::StartRemovingStagedPackages();
     }
 
     void CodePushNativeModule::GetConstants(winrt::Microsoft::ReactNative::ReactConstantProvider& constants) noexcept
@@ -428,6 +542,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::DownloadUpdateAsync(JsonObject updatePackage, bool notifyProgress, ReactPromise<IJsonValue> promise) noexcept
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         auto binaryBundle{ co_await GetBinaryBundleAsync() };
         if (binaryBundle != nullptr)
         {
@@ -482,15 +598,29 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::GetConfiguration(ReactPromise<IJsonValue> promise) noexcept 
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         auto configuration{ CodePushConfig::Current().GetConfiguration() };
         if (isRunningBinaryVersion)
         {
-            auto errorMessage{ L"Error: Package hashing is currently unimplemented. Binary hash was not obtained." };
-            auto error{ hresult_error(E_NOTIMPL, errorMessage) };
-            CodePushUtils::Log(error);
-            CodePushUtils::Log(L"Error obtaining hash for binary contents.");
-            promise.Resolve(configuration);
-            co_return;
+            // Only get the binary hash if the app is running the binary version,
+            // since the server only needs it to produce diffs against the binary.
+            try
+            {
+                auto binaryHash{ co_await CodePushUpdateUtils::GetHashForBinaryContentsAsync(
+                    co_await GetBinaryBundleAsync(),
+                    co_await GetBundleAssetsFolderAsync(),
+                    CodePushConfig::Current().GetAppVersion()) };
+                if (!binaryHash.empty())
+                {
+                    configuration.Insert(PackageHashKey, JsonValue::CreateStringValue(binaryHash));
+                }
+            }
+            catch (hresult_error const& ex)
+            {
+                CodePushUtils::Log(ex);
+                CodePushUtils::Log(L"Error obtaining hash for binary contents.");
+            }
         }
         promise.Resolve(configuration);
     }
@@ -500,6 +630,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::GetUpdateMetadataAsync(CodePushUpdateState updateState, ReactPromise<IJsonValue> promise) noexcept 
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
+
         auto package{ co_await CodePushPackage::GetCurrentPackageAsync() };
         if (package == nullptr)
         {
@@ -547,6 +679,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::InstallUpdateAsync(JsonObject updatePackage, CodePushInstallMode installMode, int minimumBackgroundDuration, ReactPromise<void> promise) noexcept 
     { 
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         try
         {
             co_await CodePushPackage::InstallPackageAsync(updatePackage, IsPendingUpdate(L""));
@@ -568,6 +702,14 @@ namespace Microsoft::CodePush::ReactNative
 
         // Signal to JS that the update has been applied.
         promise.Resolve();
+
+        if (CodePushConfig::Current().GetBundlePrewarmBudget() > 0)
+        {
+            if (auto bundleFile{ co_await CodePushPackage::GetCurrentPackageBundleAsync() })
+            {
+                PrewarmBundle(bundleFile.Path());
+            }
+        }
         co_return; 
     }
 
@@ -593,13 +735,11 @@ namespace Microsoft::CodePush::ReactNative
             return;
         }
 
-        auto localSettings{ GetLocalSettings() };
-        JsonObject latestRollbackInfo;
-        auto res{ localSettings.Values().TryLookup(LatestRollbackInfoKey) };
-        if (res != nullptr)
+        auto& settingsStore{ CodePushSettingsStore::Current() };
+        auto latestRollbackInfo{ settingsStore.GetLatestRollbackInfo() };
+        if (latestRollbackInfo == nullptr)
         {
-            auto infoString{ unbox_value<hstring>(res) };
-            JsonObject::TryParse(infoString, latestRollbackInfo);
+            latestRollbackInfo = JsonObject{};
         }
 
         auto initialRollbackCount{ GetRollbackCountForPackage(packageHash, latestRollbackInfo) };
@@ -610,7 +750,7 @@ namespace Microsoft::CodePush::ReactNative
         latestRollbackInfo.Insert(LatestRollbackTimeKey, JsonValue::CreateNumberValue(static_cast<double>(currentTimeMillis)));
         latestRollbackInfo.Insert(LatestRollbackPackageHashKey, JsonValue::CreateStringValue(packageHash));
 
-        localSettings.Values().Insert(LatestRollbackInfoKey, box_value(latestRollbackInfo.Stringify()));
+        settingsStore.SetLatestRollbackInfo(latestRollbackInfo);
     }
 
     /*
@@ -625,31 +765,40 @@ namespace Microsoft::CodePush::ReactNative
             co_await ClearDebugUpdates();
         }
 
-        auto localSettings{ GetLocalSettings() };
-        auto pendingUpdateData{ localSettings.Values().TryLookup(PendingUpdateKey) };
-        if (pendingUpdateData != nullptr)
+        auto hasPendingUpdate{ false };
+        auto updateIsLoading{ false };
+        hstring pendingUpdateHash;
+
+        CodePushStatusRecord record;
+        if (CodePushStatusRecord::TryLoad(record))
+        {
+            hasPendingUpdate = record.HasFlag(CodePushStatusRecord::HasPendingUpdate);
+            updateIsLoading = record.HasFlag(CodePushStatusRecord::PendingUpdateIsLoading);
+            pendingUpdateHash = record.pendingPackage.View();
+        }
+        else if (auto pendingUpdate{ CodePushSettingsStore::Current().GetPendingUpdate() })
         {
-            auto pendingUpdateString{ unbox_value<hstring>(pendingUpdateData) };
-            JsonObject pendingUpdate;
-            auto success{ JsonObject::TryParse(pendingUpdateString, pendingUpdate) };
-            if (success)
+            hasPendingUpdate = true;
+            updateIsLoading = pendingUpdate.GetNamedBoolean(CodePushSettingsStore::PendingUpdateIsLoadingKey, false);
+            pendingUpdateHash = pendingUpdate.GetNamedString(CodePushSettingsStore::PendingUpdateHashKey, L"");
+        }
+
+        if (hasPendingUpdate)
+        {
+            m_isFirstRunAfterUpdate = true;
+            if (updateIsLoading)
             {
-                m_isFirstRunAfterUpdate = true;
-                auto updateIsLoading{ pendingUpdate.GetNamedBoolean(PendingUpdateIsLoadingKey, false) };
-                if (updateIsLoading)
-                {
-                    // Pending update was initialized, but notifyApplicationReady was not called.
-                    // Therefore, deduce that it is a broken update and rollback.
-                    CodePushUtils::Log(L"Update did not finish loading the last time, rolling back to a previous version.");
-                    needToReportRollback = true;
-                    co_await RollbackPackage();
-                }
-                else
-                {
-                    // Mark that we tried to initialize the new update, so that if it crashes,
-                    // we will know that we need to rollback when the app next starts.
-                    SavePendingUpdate(pendingUpdate.GetNamedString(PendingUpdateHashKey, L""), true);
-                }
+                // Pending update was initialized, but notifyApplicationReady was not called.
+                // Therefore, deduce that it is a broken update and rollback.
+                CodePushUtils::Log(L"Update did not finish loading the last time, rolling back to a previous version.");
+                needToReportRollback = true;
+                co_await RollbackPackage();
+            }
+            else
+            {
+                // Mark that we tried to initialize the new update, so that if it crashes,
+                // we will know that we need to rollback when the app next starts.
+                SavePendingUpdate(pendingUpdateHash, true);
             }
         }
     }
@@ -661,12 +810,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     void CodePushNativeModule::GetLatestRollbackInfo(ReactPromise<IJsonValue> promise) noexcept 
     {
-        auto localSettings{ GetLocalSettings() };
-        auto res{ localSettings.Values().TryLookup(LatestRollbackInfoKey) };
-        auto infoString{ unbox_value<hstring>(res) };
-        JsonObject latestRollbackInfo;
-        auto success{ JsonObject::TryParse(infoString, latestRollbackInfo) };
-        if (success)
+        auto latestRollbackInfo{ CodePushSettingsStore::Current().GetLatestRollbackInfo() };
+        if (latestRollbackInfo != nullptr)
         {
             promise.Resolve(latestRollbackInfo);
         }
@@ -682,6 +827,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::IsFirstRun(std::wstring packageHash, ReactPromise<bool> promise) noexcept
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
+
         auto isFirstRun = m_isFirstRunAfterUpdate
             && !packageHash.empty()
             && packageHash == co_await CodePushPackage::GetCurrentPackageHashAsync();
@@ -743,6 +890,8 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::ClearUpdates() noexcept 
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         co_await ClearUpdatesStaticAsync();
     }
 
@@ -766,24 +915,19 @@ namespace Microsoft::CodePush::ReactNative
      */
     fire_and_forget CodePushNativeModule::GetNewStatusReportAsync(ReactPromise<IJsonValue> promise) noexcept 
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Critical);
+
         if (needToReportRollback)
         {
             needToReportRollback = false;
-            auto localSettings{ GetLocalSettings() };
-            auto failedUpdatesData{ localSettings.Values().TryLookup(FailedUpdatesKey) };
-            if (failedUpdatesData != nullptr)
+            auto failedUpdates{ CodePushSettingsStore::Current().GetFailedUpdates() };
+            if (failedUpdates.Size() > 0)
             {
-                auto failedUpdatesString{ unbox_value<hstring>(failedUpdatesData) };
-                JsonArray failedUpdates;
-                auto success{ JsonArray::TryParse(failedUpdatesString, failedUpdates) };
-                if (success)
+                auto lastFailedPackage{ failedUpdates.GetObjectAt(failedUpdates.Size() - 1) };
+                if (lastFailedPackage != nullptr)
                 {
-                    auto lastFailedPackage{ failedUpdates.GetObjectAt(failedUpdates.Size() - 1) };
-                    if (lastFailedPackage != nullptr)
-                    {
-                        promise.Resolve(CodePushTelemetryManager::GetRollbackReport(lastFailedPackage));
-                        co_return;
-                    }
+                    promise.Resolve(CodePushTelemetryManager::GetRollbackReport(lastFailedPackage));
+                    co_return;
                 }
             }
         }
@@ -816,6 +960,45 @@ namespace Microsoft::CodePush::ReactNative
         co_return;
     }
 
+    fire_and_forget CodePushNativeModule::RequestAsync(
+        std::wstring method,
+        std::wstring url,
+        JsonObject headers,
+        std::wstring body,
+        ReactPromise<IJsonValue> promise) noexcept
+    {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
+        try
+        {
+            Windows::Web::Http::HttpRequestMessage request{ Windows::Web::Http::HttpMethod{ method }, Uri{ url } };
+            if (!body.empty())
+            {
+                request.Content(Windows::Web::Http::HttpStringContent{ body, Streams::UnicodeEncoding::Utf8, L"application/json" });
+            }
+            for (auto const& header : headers)
+            {
+                // The content type is set on the content above
+                if (_wcsicmp(header.Key().c_str(), L"Content-Type") != 0)
+                {
+                    request.Headers().TryAppendWithoutValidation(header.Key(), header.Value().GetString());
+                }
+            }
+
+            auto response{ co_await CodePushHttpClient::SendRequestAsync(request, Windows::Web::Http::HttpCompletionOption::ResponseContentRead) };
+            auto responseBody{ co_await response.Content().ReadAsStringAsync() };
+
+            JsonObject result;
+            result.Insert(L"statusCode", JsonValue::CreateNumberValue(static_cast<int32_t>(response.StatusCode())));
+            result.Insert(L"body", JsonValue::CreateStringValue(responseBody));
+            promise.Resolve(result);
+        }
+        catch (hresult_error const& ex)
+        {
+            promise.Reject(ex.message().c_str());
+        }
+    }
+
     void CodePushNativeModule::RecordStatusReported(JsonObject statusReport) noexcept 
     {
         CodePushTelemetryManager::RecordStatusReported(statusReport);
@@ -174,6 +174,18 @@ namespace Microsoft::CodePush::ReactNative
 		REACT_METHOD(GetNewStatusReportAsync, L"getNewStatusReport");
 		winrt::fire_and_forget GetNewStatusReportAsync(winrt::Microsoft::ReactNative::ReactPromise<winrt::Windows::Data::Json::IJsonValue> promise) noexcept;
 
+		/*
+		 * This is the native side of request-fetch-adapter: update checks and status reports are sent
+		 * through the same HTTP client as package downloads, so that they share its connections.
+		 */
+		REACT_METHOD(RequestAsync, L"request");
+		winrt::fire_and_forget RequestAsync(
+			std::wstring method,
+			std::wstring url,
+			winrt::Windows::Data::Json::JsonObject headers,
+			std::wstring body,
+			winrt::Microsoft::ReactNative::ReactPromise<winrt::Windows::Data::Json::IJsonValue> promise) noexcept;
+
 		REACT_METHOD(RecordStatusReported, L"recordStatusReported");
 		void RecordStatusReported(winrt::Windows::Data::Json::JsonObject statusReport) noexcept;
 
@@ -203,15 +215,6 @@ namespace Microsoft::CodePush::ReactNative
 		static constexpr std::wstring_view DeploymentFailed{ L"DeploymentFailed" };
 		static constexpr std::wstring_view DeploymentSucceeded{ L"DeploymentSucceeded" };
 
-		// These keys represent the names we use to store data in LocalSettings
-		static constexpr std::wstring_view FailedUpdatesKey{ L"CODE_PUSH_FAILED_UPDATES" };
-		static constexpr std::wstring_view PendingUpdateKey{ L"CODE_PUSH_PENDING_UPDATE" };
-
-		// These keys are already "namespaced" by the PendingUpdateKey, so
-		// their values don't need to be obfuscated to prevent collision with app data
-		static constexpr std::wstring_view PendingUpdateHashKey{ L"hash" };
-		static constexpr std::wstring_view PendingUpdateIsLoadingKey{ L"isLoading" };
-
 		// These keys are used to inspect/augment the metadata
 		// that is associated with an update's package.
 		static constexpr std::wstring_view AppVersionKey{ L"appVersion" };
@@ -226,7 +229,6 @@ namespace Microsoft::CodePush::ReactNative
 		winrt::Microsoft::ReactNative::ReactContext m_context;
 
 		// These keys represent the names we use to store information about the latest rollback
-		static constexpr std::wstring_view LatestRollbackInfoKey{ L"LATEST_ROLLBACK_INFO" };
 		static constexpr std::wstring_view LatestRollbackPackageHashKey{ L"packageHash" };
 		static constexpr std::wstring_view LatestRollbackTimeKey{ L"time" };
 		static constexpr std::wstring_view LatestRollbackCountKey{ L"count" };
@@ -236,7 +238,10 @@ namespace Microsoft::CodePush::ReactNative
 
 		static winrt::Windows::Foundation::IAsyncAction ClearUpdatesStaticAsync();
 		void DispatchDownloadProgressEvent();
+		static winrt::Windows::Foundation::IAsyncAction MigrateStatusRecordAsync();
 		winrt::Windows::Foundation::IAsyncAction InitializeUpdateAfterRestart();
+		static void PrewarmBundle(winrt::hstring const& bundlePath);
+		static void ReloadBundle(winrt::hstring const& bundlePath);
 		winrt::Windows::Foundation::IAsyncAction RollbackPackage();
 		static void RemoveFailedUpdates();
 		static void RemovePendingUpdate();
@@ -4,13 +4,20 @@
 #include "pch.h"
 
 #include "CodePushDownloadHandler.h"
+#include "CodePushExecutor.h"
+#include "CodePushConfig.h"
+#include "CodePushExtractionJournal.h"
+#include "CodePushInstallReservation.h"
 #include "CodePushNativeModule.h"
 #include "CodePushPackage.h"
+#include "CodePushPackageCache.h"
+#include "CodePushStatusRecord.h"
 #include "CodePushUtils.h"
 #include "CodePushUpdateUtils.h"
 #include "FileUtils.h"
 
 #include <winrt/Windows.Storage.h>
+#include <winrt/Windows.Storage.FileProperties.h>
 #include <winrt/Windows.Storage.Streams.h>
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.Storage.AccessCache.h>
@@ -27,61 +34,227 @@ namespace Microsoft::CodePush::ReactNative
     using namespace Windows::Storage;
     using namespace Windows::Storage::Streams;
 
+    // The full path of a package's bundle, from the path its metadata records relative to the package folder
+    static std::wstring GetPackageBundlePath(std::wstring_view packageHash, std::wstring_view relativeBundlePath)
+    {
+        std::wstring bundlePath{ CodePushNativeModule::GetLocalStorageFolder().Path() };
+        bundlePath += L"\\CodePush\\";
+        bundlePath += packageHash;
+        bundlePath += L'\\';
+        bundlePath += relativeBundlePath;
+        std::replace(bundlePath.begin(), bundlePath.end(), L'/', L'\\');
+        return bundlePath;
+    }
+
+    std::mutex CodePushPackage::s_stagedPackagesRemovalMutex;
+    IAsyncAction CodePushPackage::s_stagedPackagesRemoval{ nullptr };
+
     /*static*/ IAsyncAction CodePushPackage::ClearUpdatesAsync()
     {
         if (auto codePushFolder{ co_await GetCodePushFolderAsync() })
         {
+            if (CodePushConfig::Current().GetPackageCacheBudget() > 0)
+            {
+                // Only the installed state goes: the packages are left for the cache to keep what fits its budget
+                try
+                {
+                    if (auto statusFile{ co_await GetStatusFileAsync() }) co_await statusFile.DeleteAsync();
+                }
+                catch (hresult_error const& ex) { CodePushUtils::Log(L"[CodePush] ClearUpdatesAsync delete failed: " + ex.message()); }
+                CodePushStatusRecord::Delete();
+                CodePushPackageCache::MarkCleared();
+                CodePushPackageCache::Collect();
+                co_return;
+            }
+
             try { co_await codePushFolder.DeleteAsync(); }
             catch (hresult_error const& ex) { CodePushUtils::Log(L"[CodePush] ClearUpdatesAsync delete failed: " + ex.message()); }
         }
         co_return;
     }
 
+    // Maps a bundle path recorded during extraction to where CopyEntriesInFolderAsync will place it,
+    // which drops a lone top-level "CodePush" folder. Call before the extracted folder is copied.
+    static IAsyncOperation<hstring> GetCopiedBundlePathAsync(StorageFolder const& extractedRoot, hstring const& extractedPath)
+    {
+        std::wstring_view path{ extractedPath };
+        const auto prefix{ std::wstring{ CodePushUpdateUtils::ManifestFolderPrefix } + L"\\" };
+        if (path.size() <= prefix.size() || _wcsnicmp(path.data(), prefix.c_str(), prefix.size()) != 0)
+        {
+            co_return extractedPath;
+        }
+
+        auto items{ co_await extractedRoot.GetItemsAsync() };
+        if (items.Size() == 1 && items.GetAt(0).IsOfType(StorageItemTypes::Folder))
+        {
+            co_return hstring{ path.substr(prefix.size()) };
+        }
+        co_return extractedPath;
+    }
+
+    // Reads the entry hashes kept in a package folder (see CodePushUpdateUtils::EntryHashesFileName), or returns nullptr.
+    static IAsyncOperation<JsonObject> ReadEntryHashesAsync(StorageFolder const& packageFolder)
+    {
+        JsonObject entryHashes{ nullptr };
+        if (!packageFolder)
+        {
+            co_return entryHashes;
+        }
+
+        if (auto entryHashesFile{ (co_await packageFolder.TryGetItemAsync(CodePushUpdateUtils::EntryHashesFileName)).try_as<StorageFile>() })
+        {
+            JsonObject parsed;
+            if (JsonObject::TryParse(co_await FileIO::ReadTextAsync(entryHashesFile, UnicodeEncoding::Utf8), parsed))
+            {
+                entryHashes = parsed;
+            }
+        }
+        co_return entryHashes;
+    }
+
     /*static*/ IAsyncAction CodePushPackage::DownloadPackageAsync(
         JsonObject& updatePackage,
         std::wstring_view expectedBundleFileName,
         std::wstring_view publicKey,
         std::function<void(int64_t, int64_t)> progressCallback)
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         // Wrap the whole flow to ensure we surface useful logs in Release
         try
         {
+            // Leftovers of earlier runs go first, so that removing them can't race with staging this package
+            IAsyncAction stagedPackagesRemoval{ nullptr };
+            {
+                std::lock_guard lock{ s_stagedPackagesRemovalMutex };
+                std::swap(stagedPackagesRemoval, s_stagedPackagesRemoval);
+            }
+            if (stagedPackagesRemoval)
+            {
+                co_await stagedPackagesRemoval;
+                co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+            }
+
             const auto newUpdateHash{ updatePackage.GetNamedString(L"packageHash") };
             auto codePushFolder{ co_await GetCodePushFolderAsync() };
             if (!codePushFolder) { throw hresult_error(E_FAIL, L"[CodePush] CodePush folder unavailable."); }
 
+            // A package kept from an earlier install only takes the metadata it has in this release (e.g. its label)
+            if (auto keptPackage{ co_await CodePushPackageCache::TryGetPackageAsync(newUpdateHash) })
+            {
+                auto packageMetadata{ updatePackage };
+                for (auto key : { RelativeBundlePathKey, CodePushUpdateUtils::BundleFormatKey, CodePushUpdateUtils::BundleSizeKey, CodePushUpdateUtils::BundleHashKey })
+                {
+                    if (auto value{ keptPackage.TryLookup(key) }) packageMetadata.Insert(key, value);
+                }
+
+                auto packageFolder{ co_await codePushFolder.GetFolderAsync(newUpdateHash) };
+                auto metadataFile{ co_await packageFolder.CreateFileAsync(hstring{ UpdateMetadataFileName } + L".new", CreationCollisionOption::ReplaceExisting) };
+                co_await FileIO::WriteTextAsync(metadataFile, packageMetadata.Stringify());
+                co_await metadataFile.RenameAsync(UpdateMetadataFileName, NameCollisionOption::ReplaceExisting);
+
+                CodePushUtils::Log(L"[CodePush] Reusing the kept package " + newUpdateHash);
+                co_return;
+            }
+
             // Work under a short cache path to avoid path-length surprises
             auto cacheRoot = ApplicationData::Current().LocalCacheFolder();
             auto workRoot = co_await cacheRoot.CreateFolderAsync(L"cpw", CreationCollisionOption::OpenIfExists);
-            auto unzipFolder = co_await workRoot.CreateFolderAsync(L"u", CreationCollisionOption::ReplaceExisting);
+            const std::wstring journalPath{ std::wstring{ workRoot.Path() } + L"\\" + std::wstring{ ExtractionJournalFileName } };
+
+            // If the app was killed while extracting this package, reuse its archive and resume from the journal
+            StorageFile downloadFile{ nullptr };
+            auto extractionMarker{ (co_await workRoot.TryGetItemAsync(ExtractionMarkerFileName)).try_as<StorageFile>() };
+            if (extractionMarker && co_await FileIO::ReadTextAsync(extractionMarker) == newUpdateHash)
+            {
+                downloadFile = (co_await codePushFolder.TryGetItemAsync(DownloadFileName)).try_as<StorageFile>();
+            }
+            const bool isResuming{ downloadFile != nullptr };
+
+            auto unzipFolder = co_await workRoot.CreateFolderAsync(L"u",
+                isResuming ? CreationCollisionOption::OpenIfExists : CreationCollisionOption::ReplaceExisting);
 
-            // Download to CodePush root (stable, persisted)
-            auto downloadFile = co_await codePushFolder.CreateFileAsync(DownloadFileName, CreationCollisionOption::ReplaceExisting);
+            bool isZip = true;
+            if (isResuming)
+            {
+                CodePushUtils::Log(L"[CodePush] Resuming the interrupted extraction of " + newUpdateHash);
+                const auto downloadSize{ static_cast<int64_t>((co_await downloadFile.GetBasicPropertiesAsync()).Size()) };
+                if (progressCallback) progressCallback(downloadSize, downloadSize);
+            }
+            else
+            {
+                if (extractionMarker) co_await extractionMarker.DeleteAsync();
+                if (auto staleDiffManifest{ co_await workRoot.TryGetItemAsync(DiffManifestFileName) }) co_await staleDiffManifest.DeleteAsync();
+                CodePushExtractionJournal::Delete(journalPath);
+
+                // Download to CodePush root (stable, persisted)
+                downloadFile = co_await codePushFolder.CreateFileAsync(DownloadFileName, CreationCollisionOption::ReplaceExisting);
 
-            CodePushDownloadHandler downloadHandler{ downloadFile, progressCallback };
-            const bool isZip = co_await downloadHandler.Download(updatePackage.GetNamedString(L"downloadUrl"));
-            CodePushUtils::Log(isZip ? L"[CodePush] Downloaded ZIP." : L"[CodePush] Downloaded single bundle file.");
+                CodePushDownloadHandler downloadHandler{ downloadFile, progressCallback };
+                isZip = co_await downloadHandler.Download(updatePackage.GetNamedString(L"downloadUrl"));
+                CodePushUtils::Log(isZip ? L"[CodePush] Downloaded ZIP." : L"[CodePush] Downloaded single bundle file.");
 
-            // Create destination for this hash
-            StorageFolder newUpdateFolder{ co_await codePushFolder.CreateFolderAsync(newUpdateHash, CreationCollisionOption::ReplaceExisting) };
+                if (isZip)
+                {
+                    extractionMarker = co_await workRoot.CreateFileAsync(ExtractionMarkerFileName, CreationCollisionOption::ReplaceExisting);
+                    co_await FileIO::WriteTextAsync(extractionMarker, newUpdateHash);
+                }
+            }
+
+            // Stage the package next to where it goes; it only appears under its hash once it is complete
+            StorageFolder newUpdateFolder{ co_await codePushFolder.CreateFolderAsync(newUpdateHash + hstring{ StagedPackageSuffix }, CreationCollisionOption::ReplaceExisting) };
             StorageFile newUpdateMetadataFile{ nullptr };
             auto mutableUpdatePackage{ updatePackage };
 
             if (isZip)
             {
+                // Files whose archive hash matches the installed package's are copied from it rather than inflated
+                auto currentPackageFolder{ co_await GetCurrentPackageFolderAsync() };
+                auto installedHashes{ co_await ReadEntryHashesAsync(currentPackageFolder) };
+                JsonObject entryHashes;
+
+                // Extraction plans the whole install from the archive and fails before writing if it doesn't fit; the space
+                // it reserves for the package folder is held until the copies below write it
+                CodePushInstallReservation reservation{ std::wstring{ workRoot.Path() } + L"\\" + std::wstring{ InstallReservationFileName },
+                    CodePushConfig::Current().GetInstallBudget() };
+
                 // Unzip to the short cache path, then copy over (our copy function tolerates long content paths)
-                co_await FileUtils::UnzipAsync(downloadFile, unzipFolder);
-                co_await downloadFile.DeleteAsync();
+                auto bundleInfo{ co_await FileUtils::UnzipAsync(downloadFile, unzipFolder, hstring{ expectedBundleFileName }, hstring{ journalPath },
+                    entryHashes, installedHashes, currentPackageFolder ? currentPackageFolder.Path() : hstring{}, &reservation) };
+                if (entryHashes.HasKey(DiffManifestFileName)) entryHashes.Remove(DiffManifestFileName);
+                JsonObject packageHashes{ entryHashes };
 
+                // The diff manifest is moved out of the extracted content rather than deleted, so that a resumed
+                // extraction, which doesn't extract it again, still finds it
                 bool isDiffUpdate = false;
-                if (auto diffManifestFile{ (co_await unzipFolder.TryGetItemAsync(DiffManifestFileName)).try_as<StorageFile>() })
+                auto diffManifestFile{ (co_await unzipFolder.TryGetItemAsync(DiffManifestFileName)).try_as<StorageFile>() };
+                if (diffManifestFile)
+                {
+                    co_await diffManifestFile.MoveAsync(workRoot, DiffManifestFileName, NameCollisionOption::ReplaceExisting);
+                }
+                else if (isResuming)
+                {
+                    diffManifestFile = (co_await workRoot.TryGetItemAsync(DiffManifestFileName)).try_as<StorageFile>();
+                }
+
+                if (diffManifestFile)
                 {
                     isDiffUpdate = true;
 
-                    if (auto currentPackageFolder{ co_await GetCurrentPackageFolderAsync() })
+                    // The package's files are the installed ones, updated by the archive's
+                    packageHashes = installedHashes;
+                    if (packageHashes)
+                    {
+                        for (auto const& entryHash : entryHashes)
+                        {
+                            packageHashes.Insert(entryHash.Key(), entryHash.Value());
+                        }
+                    }
+
+                    if (currentPackageFolder)
                     {
                         // Seed with previous package
-                        co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(currentPackageFolder, newUpdateFolder);
+                        co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(currentPackageFolder, newUpdateFolder, &reservation);
                     }
                     else
                     {
@@ -91,7 +264,7 @@ namespace Microsoft::CodePush::ReactNative
                         if (auto binaryAssetsFolder{ co_await CodePushNativeModule::GetBundleAssetsFolderAsync() })
                         {
                             auto newUpdateAssetsFolder{ co_await newUpdateCodePushFolder.CreateFolderAsync(CodePushUpdateUtils::AssetsFolderName) };
-                            co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(binaryAssetsFolder, newUpdateAssetsFolder);
+                            co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(binaryAssetsFolder, newUpdateAssetsFolder, &reservation);
                         }
 
                         if (auto binaryBundleFile{ co_await CodePushNativeModule::GetBinaryBundleAsync() })
@@ -113,27 +286,60 @@ namespace Microsoft::CodePush::ReactNative
                                 {
                                     co_await item.DeleteAsync();
                                 }
+                                if (packageHashes)
+                                {
+                                    const auto deletedEntryName{ deletedFileName.GetString() };
+                                    if (packageHashes.HasKey(deletedEntryName)) packageHashes.Remove(deletedEntryName);
+
+                                    const auto prefixedEntryName{ hstring{ CodePushUpdateUtils::ManifestFolderPrefix } + L"/" + deletedEntryName };
+                                    if (packageHashes.HasKey(prefixedEntryName)) packageHashes.Remove(prefixedEntryName);
+                                }
                             }
                         }
                     }
+                }
 
-                    co_await diffManifestFile.DeleteAsync();
+                // Use the bundle described during extraction; only search for it later when the archive did
+                // not contain it (e.g. a diff update that keeps the previous bundle)
+                hstring relativeBundlePath;
+                if (bundleInfo != nullptr)
+                {
+                    relativeBundlePath = co_await GetCopiedBundlePathAsync(unzipFolder, bundleInfo.GetNamedString(RelativeBundlePathKey, L""));
                 }
 
                 // Overlay extracted content into the destination
-                co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(unzipFolder, newUpdateFolder);
+                co_await CodePushUpdateUtils::CopyEntriesInFolderAsync(unzipFolder, newUpdateFolder, &reservation);
+                reservation.Close();
+
+                // Drop the marker first, so that an interruption from here on starts over
+                co_await extractionMarker.DeleteAsync();
+                CodePushExtractionJournal::Delete(journalPath);
+                if (diffManifestFile) co_await diffManifestFile.DeleteAsync();
+                co_await downloadFile.DeleteAsync();
 
                 // Clean up cache unzip folder for next run
                 try { co_await unzipFolder.DeleteAsync(); }
                 catch (...) {}
 
-                // Discover the bundle path relative to the package folder
-                auto relativeBundlePath{ co_await FileUtils::FindFilePathAsync(newUpdateFolder, expectedBundleFileName) };
                 if (!relativeBundlePath.empty())
                 {
                     mutableUpdatePackage.Insert(RelativeBundlePathKey, JsonValue::CreateStringValue(relativeBundlePath));
+                    for (auto key : { CodePushUpdateUtils::BundleFormatKey, CodePushUpdateUtils::BundleSizeKey, CodePushUpdateUtils::BundleHashKey })
+                    {
+                        mutableUpdatePackage.Insert(key, bundleInfo.GetNamedValue(key));
+                    }
+                    CodePushUtils::Log(L"[CodePush] Bundle format: " + bundleInfo.GetNamedString(CodePushUpdateUtils::BundleFormatKey));
                 }
                 else
+                {
+                    relativeBundlePath = co_await FileUtils::FindFilePathAsync(newUpdateFolder, expectedBundleFileName);
+                    if (!relativeBundlePath.empty())
+                    {
+                        mutableUpdatePackage.Insert(RelativeBundlePathKey, JsonValue::CreateStringValue(relativeBundlePath));
+                    }
+                }
+
+                if (relativeBundlePath.empty())
                 {
                     // Emit a directory listing to the log to help diagnose in Release
                     CodePushUtils::Log(L"[CodePush] Unable to locate expected bundle: " + hstring(expectedBundleFileName));
@@ -161,6 +367,21 @@ namespace Microsoft::CodePush::ReactNative
                     CodePushUtils::Log(
                         L"[CodePush] Signature/integrity verification not implemented on Windows; proceeding without blocking.");
                 }
+
+                // The package hash follows from the hashes the archive carries, without reading the files back: also warn only
+                if (packageHashes)
+                {
+                    const auto packageHash{ CodePushUpdateUtils::ComputeHashFromEntryHashes(packageHashes) };
+                    if (!packageHash.empty())
+                    {
+                        CodePushUtils::Log(packageHash == newUpdateHash ?
+                            hstring{ L"[CodePush] Package hash verified from entry hashes." } :
+                            L"[CodePush] Package hash mismatch: expected " + newUpdateHash + L", computed " + packageHash);
+                    }
+
+                    auto entryHashesFile{ co_await newUpdateFolder.CreateFileAsync(CodePushUpdateUtils::EntryHashesFileName, CreationCollisionOption::ReplaceExisting) };
+                    co_await FileIO::WriteTextAsync(entryHashesFile, packageHashes.Stringify(), UnicodeEncoding::Utf8);
+                }
             }
             else
             {
@@ -172,6 +393,8 @@ namespace Microsoft::CodePush::ReactNative
             auto newUpdateMetadataFileCreated = co_await newUpdateFolder.CreateFileAsync(UpdateMetadataFileName, CreationCollisionOption::ReplaceExisting);
             auto packageJsonString{ mutableUpdatePackage.Stringify() };
             co_await FileIO::WriteTextAsync(newUpdateMetadataFileCreated, packageJsonString);
+
+            co_await PublishPackageAsync(codePushFolder, newUpdateFolder, newUpdateHash);
         }
         catch (hresult_error const& ex)
         {
@@ -192,6 +415,88 @@ namespace Microsoft::CodePush::ReactNative
         co_return;
     }
 
+    // Renames the staged package to its hash, which is the one step that makes it visible. A package already
+    // there (the same update downloaded again) is moved aside first, since a folder can't be renamed over another.
+    /*static*/ IAsyncAction CodePushPackage::PublishPackageAsync(StorageFolder codePushFolder, StorageFolder stagedFolder, hstring packageHash)
+    {
+        const auto replacedName{ packageHash + hstring{ ReplacedPackageSuffix } };
+        auto existingFolder{ (co_await codePushFolder.TryGetItemAsync(packageHash)).try_as<StorageFolder>() };
+        if (existingFolder)
+        {
+            if (auto staleReplacedFolder{ co_await codePushFolder.TryGetItemAsync(replacedName) })
+            {
+                co_await staleReplacedFolder.DeleteAsync(StorageDeleteOption::PermanentDelete);
+            }
+            co_await existingFolder.RenameAsync(replacedName, NameCollisionOption::FailIfExists);
+        }
+
+        CodePushPackageCache::Add(packageHash, FileUtils::GetFolderBytes(std::wstring{ stagedFolder.Path() }));
+        co_await stagedFolder.RenameAsync(packageHash, NameCollisionOption::FailIfExists);
+        CodePushUtils::Log(L"[CodePush] Published package " + packageHash);
+
+        if (existingFolder)
+        {
+            try { co_await existingFolder.DeleteAsync(StorageDeleteOption::PermanentDelete); }
+            catch (hresult_error const& ex) { CodePushUtils::Log(L"[CodePush] Could not remove the replaced package: " + ex.message()); }
+        }
+    }
+
+    /*static*/ void CodePushPackage::StartRemovingStagedPackages()
+    {
+        // Once per process: after a reload, a download started before it may still be staging
+        static bool s_started{ false };
+        std::lock_guard lock{ s_stagedPackagesRemovalMutex };
+        if (!s_started)
+        {
+            s_started = true;
+            s_stagedPackagesRemoval = RemoveStagedPackagesAsync();
+        }
+    }
+
+    // Removes packages whose install was interrupted before they were published. A replaced package whose
+    // replacement was never published is put back.
+    /*static*/ IAsyncAction CodePushPackage::RemoveStagedPackagesAsync()
+    {
+        co_await CodePushExecutor::Resume(CodePushPriority::Idle);
+
+        try
+        {
+            auto codePushFolder{ (co_await CodePushNativeModule::GetLocalStorageFolder().TryGetItemAsync(L"CodePush")).try_as<StorageFolder>() };
+            if (!codePushFolder)
+            {
+                co_return;
+            }
+
+            for (auto const& folder : co_await codePushFolder.GetFoldersAsync())
+            {
+                const std::wstring_view name{ folder.Name() };
+                if (name.size() > StagedPackageSuffix.size() && name.substr(name.size() - StagedPackageSuffix.size()) == StagedPackageSuffix)
+                {
+                    CodePushUtils::Log(L"[CodePush] Removing the package staged by an interrupted install: " + folder.Name());
+                    co_await folder.DeleteAsync(StorageDeleteOption::PermanentDelete);
+                }
+                else if (name.size() > ReplacedPackageSuffix.size() && name.substr(name.size() - ReplacedPackageSuffix.size()) == ReplacedPackageSuffix)
+                {
+                    const hstring packageHash{ name.substr(0, name.size() - ReplacedPackageSuffix.size()) };
+                    if (co_await codePushFolder.TryGetItemAsync(packageHash))
+                    {
+                        co_await folder.DeleteAsync(StorageDeleteOption::PermanentDelete);
+                    }
+                    else
+                    {
+                        CodePushUtils::Log(L"[CodePush] Restoring the package an interrupted install replaced: " + packageHash);
+                        co_await folder.RenameAsync(packageHash, NameCollisionOption::FailIfExists);
+                    }
+                }
+            }
+        }
+        catch (hresult_error const& ex)
+        {
+            // Tried again on the next start
+            CodePushUtils::Log(L"[CodePush] Could not remove staged packages: " + ex.message());
+        }
+    }
+
     /*static*/ IAsyncOperation<StorageFolder> CodePushPackage::GetCodePushFolderAsync()
     {
         auto localStorage{ CodePushNativeModule::GetLocalStorageFolder() };
@@ -355,6 +660,8 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ IAsyncOperation<bool> CodePushPackage::InstallPackageAsync(JsonObject updatePackage, bool removePendingUpdate)
     {
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
         auto packageHash{ updatePackage.GetNamedString(L"packageHash") };
         auto info{ co_await GetCurrentPackageInfoAsync() };
         if (info == nullptr) co_return false;
@@ -364,26 +671,10 @@ namespace Microsoft::CodePush::ReactNative
             co_return true; // already installed
         }
 
-        if (removePendingUpdate)
+        // The package this install replaces (the pending one, or the old previous one) is left for the cache,
+        // which removes it unless packageCacheBudget keeps it
+        if (!removePendingUpdate)
         {
-            if (auto currentPackageFolder{ co_await GetCurrentPackageFolderAsync() })
-            {
-                try { co_await currentPackageFolder.DeleteAsync(); }
-                catch (...) { CodePushUtils::Log(L"[CodePush] Error deleting pending package."); }
-            }
-        }
-        else
-        {
-            auto previousPackageHash{ co_await GetPreviousPackageHashAsync() };
-            if (!previousPackageHash.empty() && previousPackageHash != packageHash)
-            {
-                if (auto previousPackageFolder{ co_await GetPackageFolderAsync(previousPackageHash) })
-                {
-                    try { co_await previousPackageFolder.DeleteAsync(); }
-                    catch (...) { CodePushUtils::Log(L"[CodePush] Error deleting old package."); }
-                }
-            }
-
             IJsonValue currentPackageVal = info.HasKey(L"currentPackage")
                 ? info.Lookup(L"currentPackage")
                 : JsonValue::CreateStringValue(L"");
@@ -392,16 +683,58 @@ namespace Microsoft::CodePush::ReactNative
         }
 
         info.Insert(L"currentPackage", JsonValue::CreateStringValue(packageHash));
-        co_return co_await UpdateCurrentPackageInfoAsync(info);
+        const auto updated{ co_await UpdateCurrentPackageInfoAsync(info) };
+        CodePushPackageCache::MarkInstalled(packageHash);
+        CodePushPackageCache::Collect();
+        co_return updated;
     }
 
-    /*static*/ IAsyncAction CodePushPackage::RollbackPackage()
+    /*static*/ IAsyncOperation<hstring> CodePushPackage::RollbackPackage()
     {
+        // The status record keeps the previous package ready to boot, so rolling back only flips the record and
+        // codepush.json. The failed package is removed in the background.
+        CodePushStatusRecord record;
+        if (CodePushStatusRecord::TryLoad(record) && !record.currentPackage.Empty())
+        {
+            const hstring failedPackageHash{ record.currentPackage.View() };
+            if (record.RollBack())
+            {
+                // GetBundleFileAsync boots from the record before codepush.json, so the record is flipped (or
+                // removed) first: after a crash between the two writes it never points at the failed package.
+                if (!CodePushStatusRecord::Save(record))
+                {
+                    CodePushUtils::Log(L"[CodePush] Unable to update the status record, falling back to JSON state.");
+                    CodePushStatusRecord::Delete();
+                }
+                JsonObject info;
+                info.Insert(L"currentPackage", JsonValue::CreateStringValue(record.currentPackage.View()));
+                co_await WriteCurrentPackageInfoAsync(info);
+
+                CodePushPackageCache::Remove(failedPackageHash);
+                CodePushPackageCache::Collect();
+
+                if (record.currentPackage.Empty())
+                {
+                    co_return L"";
+                }
+
+                // An empty path makes the caller go through LoadBundle, which handles a bundle that is gone
+                auto bundlePath{ GetPackageBundlePath(record.currentPackage.View(), record.bundlePath.View()) };
+                const auto attributes{ ::GetFileAttributesW(bundlePath.c_str()) };
+                if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+                {
+                    CodePushUtils::Log(L"[CodePush] RollbackPackage: previous bundle missing, loading through the regular path.");
+                    co_return L"";
+                }
+                co_return hstring{ bundlePath };
+            }
+        }
+
         auto info{ co_await GetCurrentPackageInfoAsync() };
         if (info == nullptr)
         {
             CodePushUtils::Log(L"[CodePush] RollbackPackage: no current package info.");
-            co_return;
+            co_return L"";
         }
 
         if (auto currentPackageFolder{ co_await GetCurrentPackageFolderAsync() })
@@ -417,6 +750,7 @@ namespace Microsoft::CodePush::ReactNative
         info.Insert(L"currentPackage", info.TryLookup(L"previousPackage"));
         info.Remove(L"previousPackage");
         co_await UpdateCurrentPackageInfoAsync(info);
+        co_return L"";
     }
 
     /*static*/ IAsyncOperation<StorageFile> CodePushPackage::GetStatusFileAsync()
@@ -426,6 +760,13 @@ namespace Microsoft::CodePush::ReactNative
     }
 
     /*static*/ IAsyncOperation<bool> CodePushPackage::UpdateCurrentPackageInfoAsync(JsonObject packageInfo)
+    {
+        co_await WriteCurrentPackageInfoAsync(packageInfo);
+        co_await UpdateStatusRecordAsync();
+        co_return true;
+    }
+
+    /*static*/ IAsyncAction CodePushPackage::WriteCurrentPackageInfoAsync(JsonObject packageInfo)
     {
         auto packageInfoString{ packageInfo.Stringify() };
         auto infoFile{ co_await GetStatusFileAsync() };
@@ -435,6 +776,63 @@ namespace Microsoft::CodePush::ReactNative
             infoFile = co_await codePushFolder.CreateFileAsync(CodePushPackage::StatusFile);
         }
         co_await FileIO::WriteTextAsync(infoFile, packageInfoString);
-        co_return true;
+    }
+
+    /*static*/ IAsyncAction CodePushPackage::UpdateStatusRecordAsync()
+    {
+        auto currentPackageHash{ co_await GetCurrentPackageHashAsync() };
+        auto previousPackageHash{ co_await GetPreviousPackageHashAsync() };
+        JsonObject currentPackage{ nullptr };
+        if (!currentPackageHash.empty())
+        {
+            currentPackage = co_await GetPackageAsync(currentPackageHash);
+        }
+
+        // The previous package is recorded as bootable only if GetBundleFileAsync would load it: its bundle is on
+        // disk and it was released for the running binary. That binary can't change while the app runs.
+        JsonObject previousPackage{ nullptr };
+        if (!previousPackageHash.empty())
+        {
+            previousPackage = co_await GetPackageAsync(previousPackageHash);
+        }
+        auto previousIsBootable{ false };
+        if (previousPackage != nullptr)
+        {
+            const auto bundlePath{ GetPackageBundlePath(previousPackageHash, previousPackage.GetNamedString(RelativeBundlePathKey, L"")) };
+            const auto attributes{ ::GetFileAttributesW(bundlePath.c_str()) };
+            if (attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0 &&
+                previousPackage.GetNamedString(L"appVersion", L"") == CodePushConfig::Current().GetAppVersion())
+            {
+                auto binaryDate{ co_await CodePushUpdateUtils::ModifiedDateStringOfFileAsync(co_await CodePushNativeModule::GetBinaryBundleAsync()) };
+                previousIsBootable = previousPackage.GetNamedString(L"binaryDate", L"") == binaryDate;
+            }
+        }
+
+        CodePushStatusRecord::Update([&](CodePushStatusRecord& record) {
+            auto fits{ record.currentPackage.Assign(currentPackageHash) };
+            fits = record.previousPackage.Assign(previousPackageHash) && fits;
+            record.bundlePath.Assign({});
+            record.appVersion.Assign({});
+            record.binaryDate.Assign({});
+            if (currentPackage != nullptr)
+            {
+                fits = record.bundlePath.Assign(currentPackage.GetNamedString(RelativeBundlePathKey, L"")) && fits;
+                fits = record.appVersion.Assign(currentPackage.GetNamedString(L"appVersion", L"")) && fits;
+                fits = record.binaryDate.Assign(currentPackage.GetNamedString(L"binaryDate", L"")) && fits;
+            }
+            record.previousBundlePath.Assign({});
+            record.previousAppVersion.Assign({});
+            record.previousBinaryDate.Assign({});
+            record.SetFlag(CodePushStatusRecord::PreviousPackageIsBootable, false);
+            if (previousIsBootable)
+            {
+                // A previous package whose fields don't fit is simply not bootable: rolling back resolves it instead
+                record.SetFlag(CodePushStatusRecord::PreviousPackageIsBootable,
+                    record.previousBundlePath.Assign(previousPackage.GetNamedString(RelativeBundlePathKey, L"")) &&
+                    record.previousAppVersion.Assign(previousPackage.GetNamedString(L"appVersion", L"")) &&
+                    record.previousBinaryDate.Assign(previousPackage.GetNamedString(L"binaryDate", L"")));
+            }
+            return fits;
+        });
     }
 }
@@ -5,14 +5,24 @@
 
 #include <winrt/Windows.Data.Json.h>
 #include <functional>
+#include <mutex>
 
 namespace Microsoft::CodePush::ReactNative
 {
 	struct CodePushPackage
 	{
+		// Also written by CodePushDiffTool (windows/CodePushDiffTool), which builds diff packages
 		static constexpr std::wstring_view DiffManifestFileName{ L"hotcodepush.json" };
 		static constexpr std::wstring_view DownloadFileName{ L"download.zip" };
+		// Kept in the extraction work folder while a downloaded archive is being extracted
+		static constexpr std::wstring_view ExtractionJournalFileName{ L"u.journal" };
+		static constexpr std::wstring_view ExtractionMarkerFileName{ L"u.package" };
+		static constexpr std::wstring_view InstallReservationFileName{ L"u.reserve" };
 		static constexpr std::wstring_view RelativeBundlePathKey{ L"bundlePath" };
+		// A package is extracted under <packageHash>.staging and renamed to <packageHash> once complete. A folder
+		// already there is moved to <packageHash>.replaced until the new one is in place.
+		static constexpr std::wstring_view ReplacedPackageSuffix{ L".replaced" };
+		static constexpr std::wstring_view StagedPackageSuffix{ L".staging" };
 		static constexpr std::wstring_view StatusFile{ L"codepush.json" };
 		static constexpr std::wstring_view UpdateBundleFileName{ L"app.jsbundle" };
 		static constexpr std::wstring_view UpdateMetadataFileName{ L"app.json" };
@@ -31,19 +41,39 @@ namespace Microsoft::CodePush::ReactNative
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFolder> GetCurrentPackageFolderAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFile> GetCurrentPackageBundleAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> GetCurrentPackageHashAsync();
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> GetPreviousPackageHashAsync();
 
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Data::Json::JsonObject> GetPackageAsync(std::wstring_view packageHash);
 
 		static winrt::Windows::Foundation::IAsyncOperation<bool> InstallPackageAsync(winrt::Windows::Data::Json::JsonObject updatePackage, bool removePendingUpdate);
 
-		static winrt::Windows::Foundation::IAsyncAction RollbackPackage();
+		// Makes the previous package the current one. Returns the path of its bundle when the status record had
+		// it ready to boot, so that it can be loaded as is; otherwise an empty string, and the bundle is resolved
+		// as on startup.
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> RollbackPackage();
+
+		// Refreshes the package fields of the binary status record from codepush.json and app.json.
+		static winrt::Windows::Foundation::IAsyncAction UpdateStatusRecordAsync();
+
+		// Starts removing what installs interrupted in earlier runs left behind, in the background. The next
+		// download waits for it before staging its own package.
+		static void StartRemovingStagedPackages();
 
 	private:
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFolder> GetCodePushFolderAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Data::Json::JsonObject> GetCurrentPackageInfoAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFolder> GetPackageFolderAsync(std::wstring_view packageHash);
-		static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> GetPreviousPackageHashAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFile> GetStatusFileAsync();
 		static winrt::Windows::Foundation::IAsyncOperation<bool> UpdateCurrentPackageInfoAsync(winrt::Windows::Data::Json::JsonObject packageInfo);
+		static winrt::Windows::Foundation::IAsyncAction WriteCurrentPackageInfoAsync(winrt::Windows::Data::Json::JsonObject packageInfo);
+
+		static winrt::Windows::Foundation::IAsyncAction PublishPackageAsync(
+			winrt::Windows::Storage::StorageFolder codePushFolder,
+			winrt::Windows::Storage::StorageFolder stagedFolder,
+			winrt::hstring packageHash);
+		static winrt::Windows::Foundation::IAsyncAction RemoveStagedPackagesAsync();
+
+		static std::mutex s_stagedPackagesRemovalMutex;
+		static winrt::Windows::Foundation::IAsyncAction s_stagedPackagesRemoval;
 	};
 }
@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushPackageCache.h"
+#include "CodePushConfig.h"
+#include "CodePushExecutor.h"
+#include "CodePushNativeModule.h"
+#include "CodePushPackage.h"
+#include "CodePushUtils.h"
+
+#include <winrt/Windows.Storage.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+    using namespace Windows::Data::Json;
+    using namespace Windows::Foundation;
+    using namespace Windows::Storage;
+
+    // packages.json: { "nextUse": n, "lastInstall": n, "packages": { "<packageHash>": { "bytes": n, "lastUse": n } } }
+    // Uses are numbered rather than timed, so that a clock change can't reorder them.
+    static constexpr std::wstring_view NextUseKey{ L"nextUse" };
+    static constexpr std::wstring_view LastInstallKey{ L"lastInstall" };
+    static constexpr std::wstring_view PackagesKey{ L"packages" };
+    static constexpr std::wstring_view BytesKey{ L"bytes" };
+    static constexpr std::wstring_view LastUseKey{ L"lastUse" };
+
+    // Held while the index is read, changed and written
+    static std::mutex s_indexMutex;
+
+    static std::wstring const& GetCodePushPath()
+    {
+        static const std::wstring s_codePushPath{ std::wstring{ CodePushNativeModule::GetLocalStorageFolder().Path() } + L"\\CodePush" };
+        return s_codePushPath;
+    }
+
+    static std::wstring GetIndexPath()
+    {
+        return GetCodePushPath() + L"\\" + std::wstring{ CodePushPackageCache::IndexFileName };
+    }
+
+    static JsonObject ReadIndex() noexcept
+    {
+        JsonObject index;
+        try
+        {
+            file_handle file{ ::CreateFile2(GetIndexPath().c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr) };
+            LARGE_INTEGER size{};
+            if (file && ::GetFileSizeEx(file.get(), &size) && size.QuadPart < 1024 * 1024)
+            {
+                std::string content(static_cast<size_t>(size.QuadPart), '\0');
+                DWORD bytesRead{ 0 };
+                JsonObject parsed;
+                if (::ReadFile(file.get(), content.data(), static_cast<DWORD>(content.size()), &bytesRead, nullptr) &&
+                    bytesRead == content.size() && JsonObject::TryParse(to_hstring(content), parsed))
+                {
+                    index = parsed;
+                }
+            }
+
+            if (!index.HasKey(PackagesKey) || index.GetNamedValue(PackagesKey).ValueType() != JsonValueType::Object)
+            {
+                index.SetNamedValue(PackagesKey, JsonObject{});
+            }
+        }
+        catch (...) {}
+        return index;
+    }
+
+    static void WriteIndex(JsonObject const& index) noexcept
+    {
+        try
+        {
+            const auto content{ to_string(index.Stringify()) };
+            const auto indexPath{ GetIndexPath() };
+            const auto tempPath{ indexPath + L".tmp" };
+            {
+                file_handle file{ ::CreateFile2(tempPath.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr) };
+                DWORD bytesWritten{ 0 };
+                if (!file ||
+                    !::WriteFile(file.get(), content.data(), static_cast<DWORD>(content.size()), &bytesWritten, nullptr) ||
+                    bytesWritten != content.size())
+                {
+                    return;
+                }
+            }
+
+            if (!::MoveFileExW(tempPath.c_str(), indexPath.c_str(), MOVEFILE_REPLACE_EXISTING))
+            {
+                ::DeleteFileW(tempPath.c_str());
+            }
+        }
+        catch (...) {}
+    }
+
+    // Numbers a new use of the index
+    static double NextUse(JsonObject const& index)
+    {
+        const auto use{ index.GetNamedNumber(NextUseKey, 1) };
+        index.SetNamedValue(NextUseKey, JsonValue::CreateNumberValue(use + 1));
+        return use;
+    }
+
+    /*static*/ void CodePushPackageCache::Add(std::wstring_view packageHash, uint64_t bytes) noexcept
+    {
+        try
+        {
+            std::lock_guard lock{ s_indexMutex };
+            auto index{ ReadIndex() };
+            JsonObject entry;
+            entry.SetNamedValue(BytesKey, JsonValue::CreateNumberValue(static_cast<double>(bytes)));
+            entry.SetNamedValue(LastUseKey, JsonValue::CreateNumberValue(NextUse(index)));
+            index.GetNamedObject(PackagesKey).SetNamedValue(packageHash, entry);
+            WriteIndex(index);
+        }
+        catch (...) {}
+    }
+
+    /*static*/ void CodePushPackageCache::MarkInstalled(std::wstring_view packageHash) noexcept
+    {
+        try
+        {
+            std::lock_guard lock{ s_indexMutex };
+            auto index{ ReadIndex() };
+            const auto use{ NextUse(index) };
+            if (auto entry{ index.GetNamedObject(PackagesKey).GetNamedObject(packageHash, nullptr) })
+            {
+                entry.SetNamedValue(LastUseKey, JsonValue::CreateNumberValue(use));
+            }
+            index.SetNamedValue(LastInstallKey, JsonValue::CreateNumberValue(use));
+            WriteIndex(index);
+        }
+        catch (...) {}
+    }
+
+    /*static*/ void CodePushPackageCache::Remove(std::wstring_view packageHash) noexcept
+    {
+        try
+        {
+            std::lock_guard lock{ s_indexMutex };
+            auto index{ ReadIndex() };
+            auto packages{ index.GetNamedObject(PackagesKey) };
+            if (packages.HasKey(packageHash))
+            {
+                packages.Remove(packageHash);
+                WriteIndex(index);
+            }
+        }
+        catch (...) {}
+    }
+
+    /*static*/ void CodePushPackageCache::MarkCleared() noexcept
+    {
+        try
+        {
+            std::lock_guard lock{ s_indexMutex };
+            auto index{ ReadIndex() };
+            index.SetNamedValue(LastInstallKey, JsonValue::CreateNumberValue(NextUse(index)));
+            WriteIndex(index);
+        }
+        catch (...) {}
+    }
+
+    /*static*/ IAsyncOperation<JsonObject> CodePushPackageCache::TryGetPackageAsync(hstring packageHash)
+    {
+        {
+            std::lock_guard lock{ s_indexMutex };
+            auto index{ ReadIndex() };
+            auto entry{ index.GetNamedObject(PackagesKey).GetNamedObject(packageHash, nullptr) };
+            if (!entry)
+            {
+                co_return nullptr;
+            }
+
+            // Used again: it is waiting to be installed, like a package just downloaded
+            entry.SetNamedValue(LastUseKey, JsonValue::CreateNumberValue(NextUse(index)));
+            WriteIndex(index);
+        }
+
+        // Published packages are complete, but check the bundle the metadata points to is still there
+        auto package{ co_await CodePushPackage::GetPackageAsync(packageHash) };
+        if (!package)
+        {
+            co_return nullptr;
+        }
+
+        std::wstring bundlePath{ GetCodePushPath() + L"\\" + std::wstring{ packageHash } + L"\\" +
+            std::wstring{ package.GetNamedString(CodePushPackage::RelativeBundlePathKey, L"") } };
+        std::replace(bundlePath.begin(), bundlePath.end(), L'/', L'\\');
+        const auto attributes{ ::GetFileAttributesW(bundlePath.c_str()) };
+        if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            co_return nullptr;
+        }
+        co_return package;
+    }
+
+    /*static*/ fire_and_forget CodePushPackageCache::Collect()
+    {
+        co_await CodePushExecutor::Resume(CodePushPriority::Idle);
+
+        try
+        {
+            auto codePushFolder{ (co_await CodePushNativeModule::GetLocalStorageFolder().TryGetItemAsync(L"CodePush")).try_as<StorageFolder>() };
+            if (!codePushFolder)
+            {
+                co_return;
+            }
+
+            // Listed before the index is read: a package is added to the index before it is published, so the
+            // index knows every folder listed here that is a published package it keeps
+            auto folders{ co_await codePushFolder.GetFoldersAsync() };
+            const auto currentHash{ co_await CodePushPackage::GetCurrentPackageHashAsync() };
+            const auto previousHash{ co_await CodePushPackage::GetPreviousPackageHashAsync() };
+            auto isFolderListed = [&folders](hstring const& name) {
+                return std::any_of(begin(folders), end(folders), [&name](StorageFolder const& folder) { return folder.Name() == name; });
+            };
+
+            JsonObject packages{ nullptr };
+            {
+                std::lock_guard lock{ s_indexMutex };
+                auto index{ ReadIndex() };
+                packages = index.GetNamedObject(PackagesKey);
+                const auto lastInstall{ index.GetNamedNumber(LastInstallKey, 0) };
+
+                struct Candidate
+                {
+                    hstring packageHash;
+                    uint64_t bytes;
+                    double lastUse;
+                };
+                std::vector<Candidate> candidates;
+                for (auto const& package : packages)
+                {
+                    const auto packageHash{ package.Key() };
+                    const auto entry{ package.Value().GetObject() };
+                    const auto lastUse{ entry.GetNamedNumber(LastUseKey, 0) };
+                    if (packageHash == currentHash || packageHash == previousHash || lastUse > lastInstall)
+                    {
+                        continue;
+                    }
+                    candidates.push_back({ packageHash, static_cast<uint64_t>(entry.GetNamedNumber(BytesKey, 0)), lastUse });
+                }
+
+                // Most recently used first; whatever doesn't fit after them is removed
+                std::sort(candidates.begin(), candidates.end(), [](Candidate const& a, Candidate const& b) { return a.lastUse > b.lastUse; });
+                const auto budget{ CodePushConfig::Current().GetPackageCacheBudget() };
+                uint64_t keptBytes{ 0 };
+                for (auto const& candidate : candidates)
+                {
+                    if (isFolderListed(candidate.packageHash) && keptBytes + candidate.bytes <= budget)
+                    {
+                        keptBytes += candidate.bytes;
+                        continue;
+                    }
+                    packages.Remove(candidate.packageHash);
+                }
+                WriteIndex(index);
+            }
+
+            for (auto const& folder : folders)
+            {
+                const auto name{ folder.Name() };
+                const std::wstring_view nameView{ name };
+                if (name == currentHash || name == previousHash || packages.HasKey(name) ||
+                    nameView.find(L'.') != std::wstring_view::npos) // staged and replaced packages (see CodePushPackage::PublishPackageAsync)
+                {
+                    continue;
+                }
+
+                CodePushUtils::Log(L"[CodePush] Removing package " + name);
+                try { co_await folder.DeleteAsync(StorageDeleteOption::PermanentDelete); }
+                catch (hresult_error const& ex) { CodePushUtils::Log(L"[CodePush] Could not remove package " + name + L": " + ex.message()); }
+            }
+        }
+        catch (hresult_error const& ex)
+        {
+            CodePushUtils::Log(L"[CodePush] Could not collect packages: " + ex.message());
+        }
+    }
+}
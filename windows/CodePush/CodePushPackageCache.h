@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <winrt/Windows.Data.Json.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * Keeps packages that stopped being the current or previous one (replaced by an install, or cleared),
+	 * up to packageCacheBudget bytes, so that downloading one of them again (e.g. after switching back to a
+	 * deployment) only rewrites its metadata, and installing it is the usual codepush.json flip. The index
+	 * (packages.json in the CodePush folder) records the size of each published package and when it was
+	 * last used; the least recently used are removed first. Packages published since the last install are
+	 * waiting to be installed, and are kept regardless of the budget.
+	 */
+	struct CodePushPackageCache
+	{
+		static constexpr std::wstring_view IndexFileName{ L"packages.json" };
+
+		// Records a package about to be published under packageHash. Call before it is renamed into place, so
+		// that Collect never sees its folder without knowing it.
+		static void Add(std::wstring_view packageHash, uint64_t bytes) noexcept;
+
+		// Records that the package was installed.
+		static void MarkInstalled(std::wstring_view packageHash) noexcept;
+
+		// Forgets a package that must not be kept (e.g. one that was rolled back), so that Collect removes it.
+		static void Remove(std::wstring_view packageHash) noexcept;
+
+		// Records that the installed packages were cleared, so that every kept package counts against the budget.
+		static void MarkCleared() noexcept;
+
+		// The metadata (app.json) of a package the index knows and that is complete on disk, or nullptr.
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Data::Json::JsonObject> TryGetPackageAsync(winrt::hstring packageHash);
+
+		// In the background, removes the least recently used packages other than the current and previous one
+		// until the rest fit the budget, along with package folders the index doesn't know.
+		static winrt::fire_and_forget Collect();
+	};
+}
@@ -0,0 +1,330 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushSettingsStore.h"
+#include "CodePushNativeModule.h"
+#include "CodePushStatusRecord.h"
+#include "CodePushUtils.h"
+
+#include "winrt/Windows.Data.Json.h"
+#include "winrt/Windows.Storage.h"
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+    using namespace Windows::Data::Json;
+    using namespace Windows::Foundation;
+    using namespace Windows::Foundation::Collections;
+    using namespace Windows::Storage;
+
+    static hstring LookupString(IPropertySet const& values, std::wstring_view key)
+    {
+        auto data{ values.TryLookup(key) };
+        return data != nullptr ? unbox_value_or<hstring>(data, L"") : hstring{};
+    }
+
+    static JsonObject LookupObject(IPropertySet const& values, std::wstring_view key)
+    {
+        JsonObject value;
+        if (auto valueString{ LookupString(values, key) }; !valueString.empty() && JsonObject::TryParse(valueString, value))
+        {
+            return value;
+        }
+        return nullptr;
+    }
+
+    static JsonArray LookupArray(IPropertySet const& values, std::wstring_view key)
+    {
+        JsonArray value;
+        if (auto valueString{ LookupString(values, key) }; !valueString.empty() && JsonArray::TryParse(valueString, value))
+        {
+            return value;
+        }
+        return JsonArray{};
+    }
+
+    /*static*/ CodePushSettingsStore& CodePushSettingsStore::Current()
+    {
+        static CodePushSettingsStore s_store;
+        return s_store;
+    }
+
+    JsonObject CodePushSettingsStore::GetPendingUpdate()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        return m_pendingUpdate;
+    }
+
+    void CodePushSettingsStore::SetPendingUpdate(std::wstring_view packageHash, bool isLoading)
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        JsonObject pendingUpdate;
+        pendingUpdate.Insert(PendingUpdateHashKey, JsonValue::CreateStringValue(packageHash));
+        pendingUpdate.Insert(PendingUpdateIsLoadingKey, JsonValue::CreateBooleanValue(isLoading));
+        m_pendingUpdate = pendingUpdate;
+        MarkDirty();
+    }
+
+    void CodePushSettingsStore::RemovePendingUpdate()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        if (m_pendingUpdate != nullptr)
+        {
+            m_pendingUpdate = nullptr;
+            MarkDirty();
+        }
+    }
+
+    JsonArray CodePushSettingsStore::GetFailedUpdates()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        return m_failedUpdates;
+    }
+
+    void CodePushSettingsStore::AddFailedUpdate(JsonObject const& failedPackage)
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        m_failedUpdates.Append(failedPackage);
+        TrimFailedUpdates();
+        MarkDirty();
+    }
+
+    void CodePushSettingsStore::RemoveFailedUpdates()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        if (m_failedUpdates.Size() > 0)
+        {
+            m_failedUpdates.Clear();
+            MarkDirty();
+        }
+    }
+
+    JsonObject CodePushSettingsStore::GetLatestRollbackInfo()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        return m_latestRollbackInfo;
+    }
+
+    void CodePushSettingsStore::SetLatestRollbackInfo(JsonObject const& latestRollbackInfo)
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        m_latestRollbackInfo = latestRollbackInfo;
+        MarkDirty();
+    }
+
+    JsonObject CodePushSettingsStore::GetRetryStatusReport()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        return m_retryStatusReport;
+    }
+
+    void CodePushSettingsStore::SetRetryStatusReport(JsonObject const& statusReport)
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        m_retryStatusReport = statusReport;
+        MarkDirty();
+    }
+
+    void CodePushSettingsStore::RemoveRetryStatusReport()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        if (m_retryStatusReport != nullptr)
+        {
+            m_retryStatusReport = nullptr;
+            MarkDirty();
+        }
+    }
+
+    hstring CodePushSettingsStore::GetLastDeploymentReport()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        return m_lastDeploymentReport;
+    }
+
+    void CodePushSettingsStore::SetLastDeploymentReport(std::wstring_view appVersionOrPackageIdentifier)
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        m_lastDeploymentReport = appVersionOrPackageIdentifier;
+        MarkDirty();
+    }
+
+    void CodePushSettingsStore::BeginTransaction()
+    {
+        std::lock_guard lock{ m_mutex };
+        m_transactionDepth++;
+    }
+
+    void CodePushSettingsStore::EndTransaction()
+    {
+        std::lock_guard lock{ m_mutex };
+        if (--m_transactionDepth == 0 && m_dirty)
+        {
+            Commit();
+        }
+    }
+
+    uint64_t CodePushSettingsStore::CommitCount()
+    {
+        std::lock_guard lock{ m_mutex };
+        return m_commitCount;
+    }
+
+    void CodePushSettingsStore::EnsureLoaded()
+    {
+        if (m_loaded)
+        {
+            return;
+        }
+        m_loaded = true;
+
+        auto values{ CodePushNativeModule::GetLocalSettings().Values() };
+        if (auto settings{ values.TryLookup(SettingsKey).try_as<ApplicationDataCompositeValue>() })
+        {
+            m_pendingUpdate = LookupObject(settings, PendingUpdateKey);
+            m_failedUpdates = LookupArray(settings, FailedUpdatesKey);
+            m_latestRollbackInfo = LookupObject(settings, LatestRollbackInfoKey);
+            m_retryStatusReport = LookupObject(settings, RetryDeploymentReportKey);
+            m_lastDeploymentReport = LookupString(settings, LastDeploymentReportKey);
+            TrimFailedUpdates();
+            return;
+        }
+
+        // Migrate the standalone keys written by earlier versions into the composite value.
+        m_pendingUpdate = LookupObject(values, PendingUpdateKey);
+        m_failedUpdates = LookupArray(values, FailedUpdatesKey);
+        m_latestRollbackInfo = LookupObject(values, LatestRollbackInfoKey);
+        m_retryStatusReport = LookupObject(values, RetryDeploymentReportKey);
+        m_lastDeploymentReport = LookupString(values, LastDeploymentReportKey);
+        TrimFailedUpdates();
+
+        auto hasLegacyState{ m_pendingUpdate != nullptr || m_failedUpdates.Size() > 0 || m_latestRollbackInfo != nullptr ||
+            m_retryStatusReport != nullptr || !m_lastDeploymentReport.empty() };
+        if (!hasLegacyState)
+        {
+            return;
+        }
+
+        // The standalone keys stay until the composite value is written, so that a failed write loses nothing
+        // (the next launch migrates them again)
+        if (!Commit())
+        {
+            return;
+        }
+        for (auto key : { PendingUpdateKey, FailedUpdatesKey, LatestRollbackInfoKey, RetryDeploymentReportKey, LastDeploymentReportKey })
+        {
+            values.TryRemove(key);
+        }
+    }
+
+    void CodePushSettingsStore::MarkDirty()
+    {
+        m_dirty = true;
+        if (m_transactionDepth == 0)
+        {
+            Commit();
+        }
+    }
+
+    void CodePushSettingsStore::TrimFailedUpdates()
+    {
+        // The oldest failures go first
+        while (m_failedUpdates.Size() > MaxFailedUpdates ||
+            (m_failedUpdates.Size() > 1 && m_failedUpdates.Stringify().size() > MaxFailedUpdatesLength))
+        {
+            m_failedUpdates.RemoveAt(0);
+        }
+    }
+
+    bool CodePushSettingsStore::Commit()
+    {
+        ApplicationDataCompositeValue settings;
+        if (m_pendingUpdate != nullptr)
+        {
+            settings.Insert(PendingUpdateKey, box_value(m_pendingUpdate.Stringify()));
+        }
+        if (m_failedUpdates.Size() > 0)
+        {
+            settings.Insert(FailedUpdatesKey, box_value(m_failedUpdates.Stringify()));
+        }
+        if (m_latestRollbackInfo != nullptr)
+        {
+            settings.Insert(LatestRollbackInfoKey, box_value(m_latestRollbackInfo.Stringify()));
+        }
+        if (m_retryStatusReport != nullptr)
+        {
+            settings.Insert(RetryDeploymentReportKey, box_value(m_retryStatusReport.Stringify()));
+        }
+        if (!m_lastDeploymentReport.empty())
+        {
+            settings.Insert(LastDeploymentReportKey, box_value(m_lastDeploymentReport));
+        }
+
+        auto committed{ false };
+        try
+        {
+            CodePushNativeModule::GetLocalSettings().Values().Insert(SettingsKey, settings);
+            m_commitCount++;
+            m_dirty = false;
+            committed = true;
+        }
+        catch (hresult_error const& ex)
+        {
+            CodePushUtils::Log(L"[CodePush] Failed to persist settings: " + ex.message());
+        }
+
+        UpdateStatusRecord();
+        return committed;
+    }
+
+    void CodePushSettingsStore::UpdateStatusRecord()
+    {
+        std::lock_guard lock{ m_mutex };
+        EnsureLoaded();
+        CodePushStatusRecord::Update([this](CodePushStatusRecord& record) {
+            auto fits{ true };
+
+            record.SetFlag(CodePushStatusRecord::HasPendingUpdate, m_pendingUpdate != nullptr);
+            record.SetFlag(CodePushStatusRecord::PendingUpdateIsLoading,
+                m_pendingUpdate != nullptr && m_pendingUpdate.GetNamedBoolean(PendingUpdateIsLoadingKey, false));
+            fits = record.pendingPackage.Assign(m_pendingUpdate != nullptr ? m_pendingUpdate.GetNamedString(PendingUpdateHashKey, L"") : hstring{}) && fits;
+
+            record.failedHashCount = 0;
+            record.SetFlag(CodePushStatusRecord::FailedHashesOverflow, false);
+            for (const auto& failedPackage : m_failedUpdates)
+            {
+                if (failedPackage.ValueType() == JsonValueType::Object)
+                {
+                    fits = record.AddFailedHash(failedPackage.GetObject().GetNamedString(L"packageHash", L"")) && fits;
+                }
+            }
+
+            record.SetFlag(CodePushStatusRecord::HasRollbackInfo, m_latestRollbackInfo != nullptr);
+            record.rollbackCount = 0;
+            record.rollbackTimeMillis = 0;
+            record.rollbackPackage.Assign({});
+            if (m_latestRollbackInfo != nullptr)
+            {
+                record.rollbackCount = static_cast<uint32_t>(m_latestRollbackInfo.GetNamedNumber(L"count", 0));
+                record.rollbackTimeMillis = static_cast<int64_t>(m_latestRollbackInfo.GetNamedNumber(L"time", 0));
+                fits = record.rollbackPackage.Assign(m_latestRollbackInfo.GetNamedString(L"packageHash", L"")) && fits;
+            }
+
+            return fits;
+        });
+    }
+}
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "winrt/Windows.Data.Json.h"
+#include "winrt/Windows.Storage.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * In-memory view of the CodePush state persisted in LocalSettings (pending update, failed updates,
+	 * latest rollback info and telemetry state). All entries are stored in a single composite value,
+	 * so one state transition is persisted with one write no matter how many entries it touches.
+	 *
+	 * Mutations made while a CodePushSettingsTransaction is alive are committed together when the
+	 * outermost transaction ends; mutations made outside of a transaction are committed immediately.
+	 * Objects returned by the getters are shared with the store and must not be modified without
+	 * passing them back to the matching setter.
+	 */
+	struct CodePushSettingsStore
+	{
+		static CodePushSettingsStore& Current();
+
+		winrt::Windows::Data::Json::JsonObject GetPendingUpdate();
+		void SetPendingUpdate(std::wstring_view packageHash, bool isLoading);
+		void RemovePendingUpdate();
+
+		winrt::Windows::Data::Json::JsonArray GetFailedUpdates();
+		void AddFailedUpdate(winrt::Windows::Data::Json::JsonObject const& failedPackage);
+		void RemoveFailedUpdates();
+
+		winrt::Windows::Data::Json::JsonObject GetLatestRollbackInfo();
+		void SetLatestRollbackInfo(winrt::Windows::Data::Json::JsonObject const& latestRollbackInfo);
+
+		winrt::Windows::Data::Json::JsonObject GetRetryStatusReport();
+		void SetRetryStatusReport(winrt::Windows::Data::Json::JsonObject const& statusReport);
+		void RemoveRetryStatusReport();
+
+		winrt::hstring GetLastDeploymentReport();
+		void SetLastDeploymentReport(std::wstring_view appVersionOrPackageIdentifier);
+
+		void BeginTransaction();
+		void EndTransaction();
+
+		// Number of durable writes made by this store since launch.
+		uint64_t CommitCount();
+
+		// Copies the pending, failed and rollback state into the binary status record.
+		void UpdateStatusRecord();
+
+		// These keys are used inside the pending update entry
+		static constexpr std::wstring_view PendingUpdateHashKey{ L"hash" };
+		static constexpr std::wstring_view PendingUpdateIsLoadingKey{ L"isLoading" };
+
+	private:
+		static constexpr std::wstring_view SettingsKey{ L"CODE_PUSH_SETTINGS" };
+
+		// These keys name the entries inside the composite value. They are also the
+		// standalone LocalSettings keys used before the store existed, which are migrated on load.
+		static constexpr std::wstring_view FailedUpdatesKey{ L"CODE_PUSH_FAILED_UPDATES" };
+		static constexpr std::wstring_view PendingUpdateKey{ L"CODE_PUSH_PENDING_UPDATE" };
+		static constexpr std::wstring_view LatestRollbackInfoKey{ L"LATEST_ROLLBACK_INFO" };
+		static constexpr std::wstring_view LastDeploymentReportKey{ L"CODE_PUSH_LAST_DEPLOYMENT_REPORT" };
+		static constexpr std::wstring_view RetryDeploymentReportKey{ L"CODE_PUSH_RETRY_DEPLOYMENT_REPORT" };
+
+		// A composite value holds at most 64 KB, and the failed updates are the only entry that grows: only the
+		// most recent ones are kept (as many as the status record holds), within this many characters.
+		static constexpr uint32_t MaxFailedUpdates{ 16 };
+		static constexpr size_t MaxFailedUpdatesLength{ 16 * 1024 };
+
+		std::recursive_mutex m_mutex;
+		bool m_loaded{ false };
+		bool m_dirty{ false };
+		uint32_t m_transactionDepth{ 0 };
+		uint64_t m_commitCount{ 0 };
+
+		winrt::Windows::Data::Json::JsonObject m_pendingUpdate{ nullptr };
+		winrt::Windows::Data::Json::JsonArray m_failedUpdates;
+		winrt::Windows::Data::Json::JsonObject m_latestRollbackInfo{ nullptr };
+		winrt::Windows::Data::Json::JsonObject m_retryStatusReport{ nullptr };
+		winrt::hstring m_lastDeploymentReport;
+
+		void EnsureLoaded();
+		void MarkDirty();
+		void TrimFailedUpdates();
+
+		// Returns false if the settings could not be written; they stay dirty, to be written with the next commit.
+		bool Commit();
+	};
+
+	struct CodePushSettingsTransaction
+	{
+		CodePushSettingsTransaction() { CodePushSettingsStore::Current().BeginTransaction(); }
+		~CodePushSettingsTransaction() { CodePushSettingsStore::Current().EndTransaction(); }
+
+		CodePushSettingsTransaction(CodePushSettingsTransaction const&) = delete;
+		CodePushSettingsTransaction& operator=(CodePushSettingsTransaction const&) = delete;
+	};
+}
@@ -0,0 +1,195 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "pch.h"
+
+#include "CodePushStatusRecord.h"
+#include "CodePushNativeModule.h"
+#include "CodePushUtils.h"
+
+#include "miniz/miniz.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    using namespace winrt;
+
+    static_assert(std::is_trivially_copyable_v<CodePushStatusRecord>, "CodePushStatusRecord is read and written as raw bytes.");
+    static_assert(std::is_standard_layout_v<CodePushStatusRecord>, "CodePushStatusRecord is read and written as raw bytes.");
+
+    static std::wstring const& GetRecordPath()
+    {
+        static const std::wstring s_recordPath{
+            std::wstring{ CodePushNativeModule::GetLocalStorageFolder().Path() } + L"\\CodePush\\" + std::wstring{ CodePushStatusRecord::FileName } };
+        return s_recordPath;
+    }
+
+    static uint32_t ComputeChecksum(CodePushStatusRecord const& record) noexcept
+    {
+        constexpr size_t checksummedOffset{ offsetof(CodePushStatusRecord, flags) };
+        auto bytes{ reinterpret_cast<uint8_t const*>(&record) + checksummedOffset };
+        return static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, bytes, sizeof(CodePushStatusRecord) - checksummedOffset));
+    }
+
+    bool CodePushStatusRecord::AddFailedHash(std::wstring_view packageHash) noexcept
+    {
+        if (packageHash.empty() || IsFailedHash(packageHash))
+        {
+            return true;
+        }
+
+        if (failedHashCount >= MaxFailedHashes)
+        {
+            SetFlag(FailedHashesOverflow, true);
+            return true;
+        }
+
+        if (!failedHashes[failedHashCount].Assign(packageHash))
+        {
+            return false;
+        }
+
+        failedHashCount++;
+        return true;
+    }
+
+    bool CodePushStatusRecord::IsFailedHash(std::wstring_view packageHash) const noexcept
+    {
+        for (uint32_t i{ 0 }; i < failedHashCount && i < MaxFailedHashes; i++)
+        {
+            if (failedHashes[i].View() == packageHash)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool CodePushStatusRecord::RollBack() noexcept
+    {
+        if (!previousPackage.Empty() && !HasFlag(PreviousPackageIsBootable))
+        {
+            return false;
+        }
+
+        currentPackage = previousPackage;
+        bundlePath = previousBundlePath;
+        appVersion = previousAppVersion;
+        binaryDate = previousBinaryDate;
+        previousPackage.Assign({});
+        previousBundlePath.Assign({});
+        previousAppVersion.Assign({});
+        previousBinaryDate.Assign({});
+        SetFlag(PreviousPackageIsBootable, false);
+        return true;
+    }
+
+    void CodePushStatusRecord::Reset() noexcept
+    {
+        std::memset(this, 0, sizeof(CodePushStatusRecord));
+        signature = Signature;
+        version = FormatVersion;
+    }
+
+    /*static*/ bool CodePushStatusRecord::TryLoad(CodePushStatusRecord& record) noexcept
+    {
+        try
+        {
+            file_handle file{ ::CreateFile2(GetRecordPath().c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr) };
+            if (!file)
+            {
+                return false;
+            }
+
+            DWORD bytesRead{ 0 };
+            if (!::ReadFile(file.get(), &record, sizeof(CodePushStatusRecord), &bytesRead, nullptr) ||
+                bytesRead != sizeof(CodePushStatusRecord))
+            {
+                return false;
+            }
+
+            return record.signature == Signature &&
+                record.version == FormatVersion &&
+                record.checksum == ComputeChecksum(record);
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    /*static*/ bool CodePushStatusRecord::Save(CodePushStatusRecord& record) noexcept
+    {
+        try
+        {
+            record.signature = Signature;
+            record.version = FormatVersion;
+            record.checksum = ComputeChecksum(record);
+
+            auto const& recordPath{ GetRecordPath() };
+            auto tempPath{ recordPath + L".tmp" };
+
+            // The CodePush folder doesn't exist yet on an install that is still running the binary version
+            const auto folderPath{ recordPath.substr(0, recordPath.rfind(L'\\')) };
+            if (!::CreateDirectoryW(folderPath.c_str(), nullptr) && ::GetLastError() != ERROR_ALREADY_EXISTS)
+            {
+                return false;
+            }
+
+            {
+                file_handle file{ ::CreateFile2(tempPath.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr) };
+                if (!file)
+                {
+                    return false;
+                }
+
+                DWORD bytesWritten{ 0 };
+                if (!::WriteFile(file.get(), &record, sizeof(CodePushStatusRecord), &bytesWritten, nullptr) ||
+                    bytesWritten != sizeof(CodePushStatusRecord) ||
+                    !::FlushFileBuffers(file.get()))
+                {
+                    return false;
+                }
+            }
+
+            if (!::MoveFileExW(tempPath.c_str(), recordPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+            {
+                ::DeleteFileW(tempPath.c_str());
+                return false;
+            }
+            return true;
+        }
+        catch (...)
+        {
+            return false;
+        }
+    }
+
+    /*static*/ void CodePushStatusRecord::Delete() noexcept
+    {
+        try
+        {
+            ::DeleteFileW(GetRecordPath().c_str());
+        }
+        catch (...) {}
+    }
+
+    /*static*/ void CodePushStatusRecord::Update(std::function<bool(CodePushStatusRecord&)> const& mutation) noexcept
+    {
+        CodePushStatusRecord record;
+        if (!TryLoad(record))
+        {
+            return;
+        }
+
+        if (!mutation(record) || !Save(record))
+        {
+            CodePushUtils::Log(L"[CodePush] Unable to update the status record, falling back to JSON state.");
+            Delete();
+        }
+    }
+}
@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	// Fixed-length, inline character storage so that the whole record is trivially copyable
+	// and can be read from disk straight into a stack instance.
+	template <size_t Capacity>
+	struct CodePushFixedString
+	{
+		uint16_t length;
+		wchar_t value[Capacity];
+
+		bool Empty() const noexcept { return length == 0; }
+		std::wstring_view View() const noexcept { return { value, length }; }
+
+		// Returns false (and leaves the value empty) if the string does not fit.
+		bool Assign(std::wstring_view text) noexcept
+		{
+			length = 0;
+			if (text.size() > Capacity) return false;
+			text.copy(value, text.size());
+			length = static_cast<uint16_t>(text.size());
+			return true;
+		}
+	};
+
+	/*
+	 * Compact binary snapshot of the state CodePush needs on startup: the current and previous
+	 * package hashes, the pending update flag, the failed hash set, the latest rollback counters
+	 * and the resolved bundle paths of the current and previous package. It mirrors codepush.json,
+	 * the current and previous packages' app.json and the CODE_PUSH_* LocalSettings entries, which
+	 * remain the source of truth. Whenever the record is missing or invalid, callers fall back to
+	 * those JSON sources.
+	 */
+	struct CodePushStatusRecord
+	{
+		static constexpr std::wstring_view FileName{ L"codepush.state" };
+		static constexpr uint32_t Signature{ 0x53504443 }; // "CDPS"
+		static constexpr uint32_t FormatVersion{ 2 };
+
+		static constexpr size_t MaxHashLength{ 64 };
+		static constexpr size_t MaxFailedHashes{ 16 };
+		static constexpr size_t MaxBundlePathLength{ 260 };
+		static constexpr size_t MaxAppVersionLength{ 64 };
+		static constexpr size_t MaxBinaryDateLength{ 32 };
+
+		enum Flags : uint32_t
+		{
+			HasPendingUpdate = 0x1,
+			PendingUpdateIsLoading = 0x2,
+			HasRollbackInfo = 0x4,
+			// More failed hashes were recorded than fit in the record; consult LocalSettings instead.
+			FailedHashesOverflow = 0x8,
+			// The previous package's fields below were checked against the disk and the running binary.
+			PreviousPackageIsBootable = 0x10,
+		};
+
+		using Hash = CodePushFixedString<MaxHashLength>;
+
+		uint32_t signature;
+		uint32_t version;
+		uint32_t checksum; // CRC-32 of every byte following this field
+		uint32_t flags;
+
+		Hash currentPackage;
+		Hash previousPackage;
+		Hash pendingPackage;
+
+		// Metadata of the current package needed to resolve its bundle without reading app.json.
+		CodePushFixedString<MaxBundlePathLength> bundlePath;
+		CodePushFixedString<MaxAppVersionLength> appVersion;
+		CodePushFixedString<MaxBinaryDateLength> binaryDate;
+
+		// The same for the previous package, so that rolling back to it doesn't resolve anything.
+		CodePushFixedString<MaxBundlePathLength> previousBundlePath;
+		CodePushFixedString<MaxAppVersionLength> previousAppVersion;
+		CodePushFixedString<MaxBinaryDateLength> previousBinaryDate;
+
+		uint32_t failedHashCount;
+		Hash failedHashes[MaxFailedHashes];
+
+		Hash rollbackPackage;
+		uint32_t rollbackCount;
+		int64_t rollbackTimeMillis;
+
+		bool HasFlag(Flags flag) const noexcept { return (flags & flag) != 0; }
+		void SetFlag(Flags flag, bool value) noexcept { flags = value ? (flags | flag) : (flags & ~flag); }
+
+		// Returns false if the hash could not be recorded; FailedHashesOverflow is set when the set is full.
+		bool AddFailedHash(std::wstring_view packageHash) noexcept;
+		bool IsFailedHash(std::wstring_view packageHash) const noexcept;
+
+		// Makes the previous package the current one from the fields recorded for it, leaving no previous
+		// package. Returns false, and changes nothing, unless the previous package is the binary or bootable.
+		bool RollBack() noexcept;
+
+		void Reset() noexcept;
+
+		// Reads the record with a single read into the caller's instance. No heap allocation occurs.
+		static bool TryLoad(CodePushStatusRecord& record) noexcept;
+
+		// Writes to a temporary file and renames it over the previous record, creating the CodePush folder if needed.
+		static bool Save(CodePushStatusRecord& record) noexcept;
+
+		static void Delete() noexcept;
+
+		// Loads the record, applies the mutation and saves it. If the record does not exist nothing
+		// happens; if the mutation or the save fails, the record is deleted so readers use the JSON state.
+		static void Update(std::function<bool(CodePushStatusRecord&)> const& mutation) noexcept;
+	};
+}
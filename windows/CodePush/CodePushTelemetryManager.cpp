@@ -4,7 +4,7 @@
 #include "pch.h"
 
 #include "CodePushTelemetryManager.h"
-#include "CodePushNativeModule.h"
+#include "CodePushSettingsStore.h"
 
 #include "winrt/Windows.Storage.h"
 #include "winrt/Windows.Data.Json.h"
@@ -21,11 +21,9 @@ namespace Microsoft::CodePush::ReactNative
     static const std::wstring_view DeploymentKeyKey{ L"deploymentKey" };
     static const std::wstring_view DeploymentSucceeded{ L"DeploymentSucceeded" };
     static const std::wstring_view LabelKey{ L"label" };
-    static const std::wstring_view LastDeploymentReportKey{ L"CODE_PUSH_LAST_DEPLOYMENT_REPORT" };
     static const std::wstring_view PackageKey{ L"package" };
     static const std::wstring_view PreviousDeploymentKeyKey{ L"previousDeploymentKey" };
     static const std::wstring_view PreviousLabelOrAppVersionKey{ L"previousLabelOrAppVersion" };
-    static const std::wstring_view RetryDeploymentReportKey{ L"CODE_PUSH_RETRY_DEPLOYMENT_REPORT" };
     static const std::wstring_view StatusKey{ L"status" };
 
     /*static*/ JsonObject CodePushTelemetryManager::GetBinaryUpdateReport(std::wstring_view appVersion)
@@ -67,19 +65,7 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ JsonObject CodePushTelemetryManager::GetRetryStatusReport()
     {
-        auto localSettings{ CodePushNativeModule::GetLocalSettings() };
-        auto retryStatusReportData{ localSettings.Values().TryLookup(RetryDeploymentReportKey) };
-        if (retryStatusReportData != nullptr)
-        {
-            auto retryStatusReportString{ unbox_value<hstring>(retryStatusReportData) };
-            JsonObject retryStatusReport;
-            auto success{ JsonObject::TryParse(retryStatusReportString, retryStatusReport) };
-            if (success)
-            {
-                return retryStatusReport;
-            }
-        }
-        return nullptr;
+        return CodePushSettingsStore::Current().GetRetryStatusReport();
     }
 
     /*static*/ JsonObject CodePushTelemetryManager::GetRollbackReport(const JsonObject& lastFailedPackage)
@@ -155,14 +141,12 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ void CodePushTelemetryManager::SaveStatusReportForRetry(const JsonObject& statusReport)
     {
-        auto localSettings{ CodePushNativeModule::GetLocalSettings() };
-        localSettings.Values().Insert(RetryDeploymentReportKey, box_value(statusReport.Stringify()));
+        CodePushSettingsStore::Current().SetRetryStatusReport(statusReport);
     }
 
     /*static*/ void CodePushTelemetryManager::ClearRetryStatusReport()
     {
-        auto localSettings{ CodePushNativeModule::GetLocalSettings() };
-        localSettings.Values().Remove(RetryDeploymentReportKey);
+        CodePushSettingsStore::Current().RemoveRetryStatusReport();
     }
 
     /*static*/ std::wstring_view CodePushTelemetryManager::GetDeploymentKeyFromStatusReportIdentifier(std::wstring_view statusReportIdentifier)
@@ -185,14 +169,7 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ hstring CodePushTelemetryManager::GetPreviousStatusReportIdentifier()
     {
-        auto localSettings{ CodePushNativeModule::GetLocalSettings() };
-        auto sentStatusReportIdentifierData{ localSettings.Values().TryLookup(LastDeploymentReportKey) };
-        if (sentStatusReportIdentifierData != nullptr)
-        {
-            auto sentStatusReportIdentifier{ unbox_value<hstring>(sentStatusReportIdentifierData) };
-            return sentStatusReportIdentifier;
-        }
-        return L"";
+        return CodePushSettingsStore::Current().GetLastDeploymentReport();
     }
 
     /*static*/ std::wstring_view CodePushTelemetryManager::GetVersionLabelFromStatusReportIdentifier(std::wstring_view statusReportIdentifier)
@@ -207,7 +184,6 @@ namespace Microsoft::CodePush::ReactNative
 
     /*static*/ void CodePushTelemetryManager::SaveStatusReportedForIdentifier(std::wstring_view appVersionOrPackageIdentifier)
     {
-        auto localSettings{ CodePushNativeModule::GetLocalSettings() };
-        localSettings.Values().Insert(LastDeploymentReportKey, box_value(appVersionOrPackageIdentifier));
+        CodePushSettingsStore::Current().SetLastDeploymentReport(appVersionOrPackageIdentifier);
     }
 }
@@ -3,26 +3,41 @@
 
 #include "pch.h" // MUST be first
 #include "CodePushUpdateUtils.h"
+#include "CodePushExecutor.h"
+#include "CodePushNativeModule.h"
 #include "CodePushUtils.h"
 
+#include <winrt/Windows.Data.Json.h>
 #include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.Storage.h>
 #include <winrt/Windows.Storage.Search.h>
 #include <winrt/Windows.Storage.Streams.h>
 #include <winrt/Windows.Globalization.DateTimeFormatting.h>
 #include <winrt/Windows.Storage.FileProperties.h>
+#include <winrt/Windows.Security.Cryptography.h>
+#include <winrt/Windows.Security.Cryptography.Core.h>
 
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace winrt;
+using namespace Windows::Data::Json;
 using namespace Windows::Foundation;
 using namespace Windows::Storage;
 using namespace Windows::Storage::Search;
 using namespace Windows::Storage::Streams;
 using namespace Windows::Globalization::DateTimeFormatting;
+using namespace Windows::Security::Cryptography;
+using namespace Windows::Security::Cryptography::Core;
 
 namespace Microsoft::CodePush::ReactNative
 {
@@ -121,7 +136,8 @@ namespace Microsoft::CodePush::ReactNative
 	// Matches CodePushUpdateUtils.h exactly
 	IAsyncAction CodePushUpdateUtils::CopyEntriesInFolderAsync(
 		Windows::Storage::StorageFolder const& sourceRoot,
-		Windows::Storage::StorageFolder const& destRoot)
+		Windows::Storage::StorageFolder const& destRoot,
+		CodePushInstallReservation* reservation)
 	{
 		StorageFolder copyRoot = co_await MaybeStripTopCodePushAsync(sourceRoot);
 
@@ -151,6 +167,15 @@ namespace Microsoft::CodePush::ReactNative
 					rel = f.Name();
 				}
 
+				if (reservation)
+				{
+					WIN32_FILE_ATTRIBUTE_DATA attributes{};
+					if (::GetFileAttributesExW(fullW.c_str(), GetFileExInfoStandard, &attributes))
+					{
+						reservation->Release((static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow);
+					}
+				}
+
 				co_await CopyFileEntryAsync(f, destRoot, rel);
 			}
 			catch (winrt::hresult_error const& ex)
@@ -211,4 +236,241 @@ namespace Microsoft::CodePush::ReactNative
 		}
 		co_return nullptr;
 	}
+
+	hstring CodePushUpdateUtils::ComputeHashForData(array_view<uint8_t const> data)
+	{
+		auto hash{ HashAlgorithmProvider::OpenAlgorithm(HashAlgorithmNames::Sha256()).CreateHash() };
+		hash.Append(CryptographicBuffer::CreateFromByteArray(data));
+		return CryptographicBuffer::EncodeToHexString(hash.GetValueAndReset());
+	}
+
+	bool CodePushUpdateUtils::IsHermesBytecode(array_view<uint8_t const> data) noexcept
+	{
+		// Hermes bytecode files start with a little-endian 64-bit magic number.
+		uint64_t magic{ 0 };
+		if (data.size() < sizeof(magic)) return false;
+		std::memcpy(&magic, data.data(), sizeof(magic));
+		return magic == HermesBytecodeMagic;
+	}
+
+	IAsyncOperation<hstring> CodePushUpdateUtils::ComputeHashForFileAsync(StorageFile file)
+	{
+		auto hash{ HashAlgorithmProvider::OpenAlgorithm(HashAlgorithmNames::Sha256()).CreateHash() };
+		auto stream{ co_await file.OpenReadAsync() };
+		Buffer buffer{ HashChunkSize };
+		while (true)
+		{
+			auto chunk{ co_await stream.ReadAsync(buffer, HashChunkSize, InputStreamOptions::None) };
+			if (chunk.Length() == 0) break;
+			hash.Append(chunk);
+		}
+		stream.Close();
+		co_return CryptographicBuffer::EncodeToHexString(hash.GetValueAndReset());
+	}
+
+	bool CodePushUpdateUtils::IsHashIgnoredFor(std::wstring_view relativePath)
+	{
+		auto isNamed = [relativePath](std::wstring_view name) {
+			return relativePath == name ||
+				(relativePath.size() > name.size() &&
+					relativePath.substr(relativePath.size() - name.size()) == name &&
+					relativePath[relativePath.size() - name.size() - 1] == L'/');
+		};
+		return relativePath.substr(0, IgnoreMacOSX.size()) == IgnoreMacOSX ||
+			isNamed(IgnoreDSStore) ||
+			isNamed(IgnoreCodePushMetadata);
+	}
+
+	hstring CodePushUpdateUtils::ComputeFinalHashFromManifest(std::vector<std::wstring>& manifest)
+	{
+		// Sort and serialize the entries exactly like the CLI does (JSON.stringify of the sorted
+		// array, which leaves "/" unescaped), so both sides hash the same UTF-8 bytes.
+		std::sort(manifest.begin(), manifest.end());
+
+		std::wstring manifestString{ L"[" };
+		for (size_t i = 0; i < manifest.size(); ++i)
+		{
+			if (i > 0) manifestString.push_back(L',');
+			manifestString.push_back(L'"');
+			for (auto ch : manifest[i])
+			{
+				switch (ch)
+				{
+				case L'"': manifestString.append(L"\\\""); break;
+				case L'\\': manifestString.append(L"\\\\"); break;
+				case L'\b': manifestString.append(L"\\b"); break;
+				case L'\f': manifestString.append(L"\\f"); break;
+				case L'\n': manifestString.append(L"\\n"); break;
+				case L'\r': manifestString.append(L"\\r"); break;
+				case L'\t': manifestString.append(L"\\t"); break;
+				default:
+					if (ch < 0x20)
+					{
+						wchar_t escaped[7]{};
+						_snwprintf_s(escaped, _countof(escaped), _TRUNCATE, L"\\u%04x", static_cast<unsigned>(ch));
+						manifestString.append(escaped);
+					}
+					else
+					{
+						manifestString.push_back(ch);
+					}
+				}
+			}
+			manifestString.push_back(L'"');
+		}
+		manifestString.push_back(L']');
+
+		auto manifestUtf8{ to_string(manifestString) };
+		return ComputeHashForData({ reinterpret_cast<uint8_t const*>(manifestUtf8.data()), static_cast<uint32_t>(manifestUtf8.size()) });
+	}
+
+	struct BinaryManifestEntry
+	{
+		std::wstring relativePath;
+		StorageFile file{ nullptr };
+		hstring hash;
+	};
+
+	// Each worker claims the next unhashed entry until none are left.
+	static IAsyncAction HashManifestEntriesAsync(std::vector<BinaryManifestEntry>& entries, std::atomic<size_t>& nextEntry)
+	{
+		co_await CodePushExecutor::Resume(CodePushPriority::Normal);
+		for (auto i{ nextEntry++ }; i < entries.size(); i = nextEntry++)
+		{
+			entries[i].hash = co_await CodePushUpdateUtils::ComputeHashForFileAsync(entries[i].file);
+		}
+	}
+
+	IAsyncOperation<hstring> CodePushUpdateUtils::GetHashForBinaryContentsAsync(
+		StorageFile binaryBundle,
+		StorageFolder assetsFolder,
+		hstring appVersion)
+	{
+		static std::mutex s_memoizedMutex;
+		static hstring s_memoizedCacheKey;
+		static hstring s_memoizedBinaryHash;
+
+		if (binaryBundle == nullptr)
+		{
+			co_return L"";
+		}
+
+		auto cacheKey{ appVersion + L":" + co_await ModifiedDateStringOfFileAsync(binaryBundle) };
+		{
+			std::lock_guard lock{ s_memoizedMutex };
+			if (cacheKey == s_memoizedCacheKey)
+			{
+				co_return s_memoizedBinaryHash;
+			}
+		}
+
+		// Get the cached hash from LocalSettings if it exists.
+		auto localSettings{ CodePushNativeModule::GetLocalSettings() };
+		if (auto cachedValue{ localSettings.Values().TryLookup(BinaryHashKey) })
+		{
+			JsonObject binaryHashDictionary;
+			if (JsonObject::TryParse(unbox_value_or<hstring>(cachedValue, L""), binaryHashDictionary) &&
+				binaryHashDictionary.HasKey(cacheKey))
+			{
+				auto binaryHash{ binaryHashDictionary.GetNamedString(cacheKey) };
+				std::lock_guard lock{ s_memoizedMutex };
+				s_memoizedCacheKey = cacheKey;
+				s_memoizedBinaryHash = binaryHash;
+				co_return binaryHash;
+			}
+			localSettings.Values().Remove(BinaryHashKey);
+		}
+
+		const auto startTime{ std::chrono::steady_clock::now() };
+
+		std::vector<BinaryManifestEntry> entries;
+		entries.push_back({ std::wstring{ ManifestFolderPrefix } + L"/" + std::wstring{ binaryBundle.Name() }, binaryBundle });
+
+		// If the app is using assets, then add them to the generated content manifest.
+		if (assetsFolder != nullptr)
+		{
+			QueryOptions qo;
+			qo.FolderDepth(FolderDepth::Deep);
+			qo.IndexerOption(IndexerOption::DoNotUseIndexer);
+
+			const std::wstring rootPath{ assetsFolder.Path() };
+			const auto assetsPrefix{ std::wstring{ ManifestFolderPrefix } + L"/" + std::wstring{ AssetsFolderName } + L"/" };
+			for (auto const& file : co_await assetsFolder.CreateFileQueryWithOptions(qo).GetFilesAsync())
+			{
+				std::wstring relativePath{ std::wstring_view{ file.Path() }.substr(rootPath.size() + 1) };
+				std::replace(relativePath.begin(), relativePath.end(), L'\\', L'/');
+				relativePath = assetsPrefix + relativePath;
+				if (!IsHashIgnoredFor(relativePath))
+				{
+					entries.push_back({ std::move(relativePath), file });
+				}
+			}
+		}
+
+		std::atomic<size_t> nextEntry{ 0 };
+		const auto workerCount{ (std::min<size_t>)((std::max)(std::thread::hardware_concurrency(), 2u), entries.size()) };
+		std::vector<IAsyncAction> workers;
+		for (size_t i = 0; i < workerCount; ++i)
+		{
+			workers.push_back(HashManifestEntriesAsync(entries, nextEntry));
+		}
+		// Every worker is awaited before an error is rethrown, since they all use entries and nextEntry from this frame
+		std::exception_ptr firstError;
+		for (auto const& worker : workers)
+		{
+			try
+			{
+				co_await worker;
+			}
+			catch (...)
+			{
+				if (!firstError) firstError = std::current_exception();
+			}
+		}
+		if (firstError)
+		{
+			std::rethrow_exception(firstError);
+		}
+
+		std::vector<std::wstring> manifest;
+		manifest.reserve(entries.size());
+		for (auto& entry : entries)
+		{
+			manifest.push_back(std::move(entry.relativePath) + L":" + std::wstring{ entry.hash });
+		}
+		auto binaryHash{ ComputeFinalHashFromManifest(manifest) };
+
+		const auto elapsedMs{ std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() };
+		CodePushUtils::Log(L"[CodePush] Hashed " + to_hstring(entries.size()) + L" binary files in " + to_hstring(elapsedMs) + L" ms.");
+
+		JsonObject binaryHashDictionary;
+		binaryHashDictionary.Insert(cacheKey, JsonValue::CreateStringValue(binaryHash));
+		localSettings.Values().Insert(BinaryHashKey, box_value(binaryHashDictionary.Stringify()));
+
+		{
+			std::lock_guard lock{ s_memoizedMutex };
+			s_memoizedCacheKey = cacheKey;
+			s_memoizedBinaryHash = binaryHash;
+		}
+		co_return binaryHash;
+	}
+
+	hstring CodePushUpdateUtils::ComputeHashFromEntryHashes(JsonObject const& entryHashes)
+	{
+		std::vector<std::wstring> manifest;
+		manifest.reserve(entryHashes.Size());
+		for (auto const& entry : entryHashes)
+		{
+			auto hash{ entry.Value().ValueType() == JsonValueType::String ? entry.Value().GetString() : hstring{} };
+			if (hash.empty())
+			{
+				return {};
+			}
+			if (!IsHashIgnoredFor(entry.Key()))
+			{
+				manifest.push_back(std::wstring{ entry.Key() } + L":" + std::wstring{ hash });
+			}
+		}
+		return ComputeFinalHashFromManifest(manifest);
+	}
 }
@@ -4,7 +4,12 @@
 #include "winrt/Windows.Foundation.h"
 #include "winrt/Windows.Storage.h"
 
+#include "CodePushInstallReservation.h"
+
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace Microsoft::CodePush::ReactNative
 {
@@ -15,9 +20,23 @@ namespace Microsoft::CodePush::ReactNative
         static constexpr std::wstring_view ManifestFolderPrefix = L"CodePush";
         static constexpr std::wstring_view BundleJWTFile = L".codepushrelease";
 
+        // Kept in a package folder: the SHA-256 stored in the package's archive for each of its files,
+        // keyed by archive entry path, with an empty string for files whose hash isn't known.
+        static constexpr std::wstring_view EntryHashesFileName = L".codepushhashes";
+
+        // These keys describe the JS bundle in an update's app.json
+        static constexpr std::wstring_view BundleFormatKey = L"bundleFormat";
+        static constexpr std::wstring_view BundleHashKey = L"bundleHash";
+        static constexpr std::wstring_view BundleSizeKey = L"bundleSize";
+        static constexpr std::wstring_view HermesBytecodeFormat = L"hbc";
+        static constexpr std::wstring_view JavaScriptFormat = L"js";
+
+        // Copies every file under sourceRoot to the same path under destRoot. With a reservation, the space
+        // for each file is given back to it as the file is copied.
         static winrt::Windows::Foundation::IAsyncAction CopyEntriesInFolderAsync(
             winrt::Windows::Storage::StorageFolder const& sourceRoot,
-            winrt::Windows::Storage::StorageFolder const& destRoot);
+            winrt::Windows::Storage::StorageFolder const& destRoot,
+            CodePushInstallReservation* reservation = nullptr);
 
         static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> ModifiedDateStringOfFileAsync(
             winrt::Windows::Storage::StorageFile const& file);
@@ -25,9 +44,38 @@ namespace Microsoft::CodePush::ReactNative
         static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFile> GetSignatureFileAsync(
             winrt::Windows::Storage::StorageFolder const& rootFolder);
 
+        // Returns the lowercase hex SHA-256 of the data, as used in CodePush manifests.
+        static winrt::hstring ComputeHashForData(winrt::array_view<uint8_t const> data);
+
+        // Streams the file through SHA-256 without loading it into memory.
+        static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> ComputeHashForFileAsync(
+            winrt::Windows::Storage::StorageFile file);
+
+        // Hashes the binary bundle and assets the same way the CLI hashes a release, so the server can
+        // serve diffs against the binary. Files are hashed in parallel and the result is cached per app
+        // version and bundle modification date, in memory and in LocalSettings under BinaryHashKey.
+        static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> GetHashForBinaryContentsAsync(
+            winrt::Windows::Storage::StorageFile binaryBundle,
+            winrt::Windows::Storage::StorageFolder assetsFolder,
+            winrt::hstring appVersion);
+
+        // Computes a package hash from the hashes of its files keyed by entry path (see EntryHashesFileName)
+        // the same way the CLI hashes a release, without reading the files. Returns an empty string if the
+        // hash of any file is unknown.
+        static winrt::hstring ComputeHashFromEntryHashes(winrt::Windows::Data::Json::JsonObject const& entryHashes);
+
+        // Returns true if the data starts with the Hermes bytecode file header.
+        static bool IsHermesBytecode(winrt::array_view<uint8_t const> data) noexcept;
+
     private:
         static constexpr std::wstring_view IgnoreMacOSX = L"__MACOSX/";
         static constexpr std::wstring_view IgnoreDSStore = L".DS_Store";
         static constexpr std::wstring_view IgnoreCodePushMetadata = L".codepushrelease";
+
+        static constexpr uint64_t HermesBytecodeMagic = 0x1F1903C103BC1FC6;
+        static constexpr uint32_t HashChunkSize = 256 * 1024;
+
+        static bool IsHashIgnoredFor(std::wstring_view relativePath);
+        static winrt::hstring ComputeFinalHashFromManifest(std::vector<std::wstring>& manifest);
     };
 }
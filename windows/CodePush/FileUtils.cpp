@@ -11,177 +11,369 @@
 #include "winrt/Windows.Storage.Streams.h"
 #include "winrt/Windows.Foundation.Collections.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstring>
 #include <cwchar>
-#include <filesystem>
-#include <stack>
+#include <memory>
 #include <string>
 #include <string_view>
+#include <unordered_set>
 #include <vector>
-#include <Windows.h> // for MultiByteToWideChar UTF-8 -> UTF-16
+#include <Windows.h>
 
+#include "CodePushEntryPath.h"
+#include "CodePushExecutor.h"
+#include "CodePushExtractionJournal.h"
+#include "CodePushInstallReservation.h"
 #include "CodePushNativeModule.h"
+#include "CodePushPackage.h"
+#include "CodePushUpdateUtils.h"
 #include "CodePushUtils.h"
 #include "FileUtils.h"
 
 namespace Microsoft::CodePush::ReactNative
 {
     using namespace winrt;
+    using namespace Windows::Data::Json;
     using namespace Windows::Foundation;
     using namespace Windows::Storage;
     using namespace Windows::Storage::Search;
     using namespace Windows::Storage::Streams;
     using namespace Windows::Foundation::Collections;
 
-    // -------------------- UTF-8 → UTF-16 helper --------------------
-    static inline std::wstring Utf8ToWide(std::string const& utf8)
+    // -------------------- small entry batching --------------------
+    // Entries up to kSmallEntryBytes are inflated back to back into a slab and written from the thread pool
+    // with plain Win32 calls, one task per slab, instead of paying a StorageFile create/open/write/close each.
+    constexpr size_t kSmallEntryBytes = size_t(16) * 1024;
+    constexpr size_t kSmallBatchSlabBytes = size_t(1024) * 1024;
+    constexpr size_t kMaxSmallBatchEntries = 512;
+    constexpr size_t kMaxSmallBatchesInFlight = 4;
+
+    struct SmallFileBatch
     {
-        if (utf8.empty()) return std::wstring{};
-        int needed = ::MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), nullptr, 0);
-        if (needed <= 0) return std::wstring{};
-        std::wstring out(static_cast<size_t>(needed), L'\0');
-        ::MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), out.data(), needed);
-        return out;
+        struct Entry
+        {
+            mz_uint index;
+            std::wstring path;
+            size_t offset;
+            size_t size;
+        };
+
+        std::vector<uint8_t> slab;
+        std::vector<Entry> entries;
+        size_t used{ 0 };
+
+        SmallFileBatch() : slab(kSmallBatchSlabBytes) {}
+
+        bool Fits(size_t size) const noexcept
+        {
+            return entries.size() < kMaxSmallBatchEntries && used + size <= slab.size();
+        }
+    };
+
+    static bool IsEntryNamed(std::wstring_view entryName, hstring const& fileName)
+    {
+        if (fileName.empty()) return false;
+        auto slash = entryName.find_last_of(L"/\\");
+        auto name = slash == std::wstring_view::npos ? entryName : entryName.substr(slash + 1);
+        return name.size() == fileName.size() && _wcsnicmp(name.data(), fileName.c_str(), name.size()) == 0;
     }
 
-    // -------------------- sanitizers --------------------
-    static inline bool IsInvalidChar(wchar_t ch)
+    // The folders an extraction has created. Entries are mostly listed folder by folder, so most share the
+    // parent of the one before and don't need to look it up.
+    struct CreatedFolders
+    {
+        std::unordered_set<std::wstring> paths;
+        std::wstring lastParent;
+    };
+
+    // Joins root (an extended-length path) and an entry's sanitized path, creating its parent folders the first
+    // time they are seen unless createdFolders is null. Returns an empty string if the entry can't be written
+    // with Win32 calls.
+    static std::wstring PrepareEntryPath(std::wstring const& root, std::wstring_view relativePath,
+        CreatedFolders* createdFolders)
     {
-        switch (ch)
+        std::wstring path;
+        path.reserve(root.size() + 1 + relativePath.size());
+        path.append(root).append(L"\\").append(relativePath);
+        if (!createdFolders) return path;
+
+        const auto parentEnd = path.rfind(L'\\');
+        if (parentEnd <= root.size()) return path;
+        const std::wstring_view parent{ path.data(), parentEnd };
+        if (parent == createdFolders->lastParent) return path;
+
+        for (auto separator = path.find(L'\\', root.size() + 1); separator != std::wstring::npos && separator <= parentEnd;
+            separator = path.find(L'\\', separator + 1))
         {
-        case L'<': case L'>': case L':': case L'"':
-        case L'/': case L'\\': case L'|': case L'?': case L'*':
-            return true;
-        default:
-            return (ch < 0x20); // control chars not allowed in names
+            std::wstring folder{ path.data(), separator };
+            if (createdFolders->paths.count(folder) > 0) continue;
+            if (!::CreateDirectoryW(folder.c_str(), nullptr) && ::GetLastError() != ERROR_ALREADY_EXISTS) return {};
+            createdFolders->paths.insert(std::move(folder));
         }
+        createdFolders->lastParent.assign(parent);
+        return path;
     }
 
-    static inline bool IsReservedDeviceName(const std::wstring& nameNoExtUpper)
+    // -------------------- unchanged entries --------------------
+    // Returns the SHA-256 recorded in the entry's hash extra field as lowercase hex (the form the rest of the
+    // module uses for hashes), or an empty string if the entry doesn't carry one.
+    static std::wstring GetEntryHash(mz_zip_archive* za, mz_uint index)
     {
-        static const std::wstring reserved[] = {
-            L"CON", L"PRN", L"AUX", L"NUL",
-            L"COM1", L"COM2", L"COM3", L"COM4", L"COM5", L"COM6", L"COM7", L"COM8", L"COM9",
-            L"LPT1", L"LPT2", L"LPT3", L"LPT4", L"LPT5", L"LPT6", L"LPT7", L"LPT8", L"LPT9"
-        };
-        for (auto const& r : reserved) if (nameNoExtUpper == r) return true;
-        return false;
+        const mz_uint8* field = nullptr;
+        mz_uint fieldSize = 0;
+        if (!mz_zip_reader_get_extra_field(za, index, MZ_ZIP_EXTENSION_HASH, &field, &fieldSize) ||
+            fieldSize != 4 + MZ_ZIP_HASH_SHA256_SIZE ||
+            (field[0] | (field[1] << 8)) != MZ_ZIP_HASH_ALGORITHM_SHA256 ||
+            (field[2] | (field[3] << 8)) != MZ_ZIP_HASH_SHA256_SIZE)
+        {
+            return {};
+        }
+
+        constexpr wchar_t kHexDigits[] = L"0123456789abcdef";
+        std::wstring hash(size_t(2) * MZ_ZIP_HASH_SHA256_SIZE, L'\0');
+        for (size_t i = 0; i < MZ_ZIP_HASH_SHA256_SIZE; ++i)
+        {
+            hash[2 * i] = kHexDigits[field[4 + i] >> 4];
+            hash[2 * i + 1] = kHexDigits[field[4 + i] & 0xF];
+        }
+        return hash;
     }
 
-    static inline void TrimTrailingDotsAndSpaces(std::wstring& s)
+    // Copies the installed package's copy of an unchanged entry to path instead of inflating it, if it is there
+    // and its size matches.
+    static bool CopyUnchangedEntry(std::wstring const& installedPath, uint64_t size, std::wstring const& path)
     {
-        while (!s.empty() && (s.back() == L'.' || s.back() == L' ')) s.pop_back();
+        WIN32_FILE_ATTRIBUTE_DATA attributes{};
+        return !installedPath.empty() &&
+            ::GetFileAttributesExW(installedPath.c_str(), GetFileExInfoStandard, &attributes) &&
+            (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 &&
+            ((static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow) == size &&
+            SUCCEEDED(::CopyFile2(installedPath.c_str(), path.c_str(), nullptr));
     }
 
-    static inline void ReplaceInvalidChars(std::wstring& s)
+    // -------------------- install planning --------------------
+    // Safety rails (defense-in-depth for Release)
+    constexpr size_t kMaxEntryBytes = size_t(200) * 1024 * 1024; // 200 MB per file
+    constexpr size_t kMaxTotalBytes = size_t(1024) * 1024 * 1024; // 1 GB per zip
+
+    // The size of the file at path, or UINT64_MAX if there is no such file.
+    static uint64_t GetFileBytes(std::wstring const& path)
     {
-        for (auto& ch : s) if (IsInvalidChar(ch)) ch = L'_';
+        WIN32_FILE_ATTRIBUTE_DATA attributes{};
+        if (path.empty() || !::GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &attributes) ||
+            (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+        {
+            return UINT64_MAX;
+        }
+        return (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
     }
 
-    // Return false if segment should be skipped entirely
-    static inline bool SanitizeSegment(std::wstring& seg)
+    /*static*/ uint64_t FileUtils::GetFolderBytes(std::wstring const& folder)
     {
-        if (seg.empty()) return false;
+        uint64_t bytes = 0;
+        WIN32_FIND_DATAW data{};
+        HANDLE find = ::FindFirstFileExW((folder + L"\\*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+        if (find == INVALID_HANDLE_VALUE) return 0;
+        do
+        {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            {
+                bytes += (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            }
+            else if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) == 0 &&
+                std::wcscmp(data.cFileName, L".") != 0 && std::wcscmp(data.cFileName, L"..") != 0)
+            {
+                bytes += GetFolderBytes(folder + L"\\" + data.cFileName);
+            }
+        } while (::FindNextFileW(find, &data));
+        ::FindClose(find);
+        return bytes;
+    }
 
-        ReplaceInvalidChars(seg);
-        TrimTrailingDotsAndSpaces(seg);
+    // Works out from the central directory what installing the archive writes. Entries an interrupted run extracted
+    // are already on disk, and oversized ones are skipped. A diff's package starts as a copy of the installed one
+    // (installedRoot), so an entry that replaces an installed file only adds what it grows by.
+    static CodePushInstallPlan PlanExtraction(mz_zip_archive* za, CodePushExtractionJournal const* journal, std::wstring const& installedRoot)
+    {
+        constexpr std::string_view kTopFolderPrefix{ "CodePush/" };
+        const std::string diffManifestName{ to_string(CodePushPackage::DiffManifestFileName) };
+
+        CodePushInstallPlan plan;
+        CodePushEntryPath entry;
+        bool isDiff = false;
+        uint64_t growthBytes = 0;
+        const mz_uint numFiles = mz_zip_reader_get_num_files(za);
+        for (mz_uint i = 0; i < numFiles; ++i)
+        {
+            mz_zip_archive_file_stat st{};
+            if (!mz_zip_reader_file_stat(za, i, &st) || st.m_is_directory || st.m_uncomp_size > kMaxEntryBytes) continue;
 
-        if (seg.empty() || seg == L"." || seg == L"..") return false;
+            const std::string_view name{ st.m_filename };
+            if (name == diffManifestName) isDiff = true;
 
-        // Reserved device names (without extension)
-        std::wstring nameNoExt = seg;
-        auto dot = nameNoExt.find_last_of(L'.');
-        if (dot != std::wstring::npos) nameNoExt = nameNoExt.substr(0, dot);
+            plan.contentBytes += st.m_uncomp_size;
+            if (!journal || !journal->IsEntryComplete(i)) plan.extractBytes += st.m_uncomp_size;
 
-        std::wstring upper; upper.reserve(nameNoExt.size());
-        for (auto c : nameNoExt) upper.push_back(::towupper(c));
-        if (IsReservedDeviceName(upper))
-        {
-            // Prefix with underscore to avoid rejection
-            seg.insert(seg.begin(), L'_');
+            if (!installedRoot.empty() && entry.Parse(name))
+            {
+                auto installedBytes = GetFileBytes(PrepareEntryPath(installedRoot, entry.Path(), nullptr));
+                if (installedBytes == UINT64_MAX && name.substr(0, kTopFolderPrefix.size()) == kTopFolderPrefix)
+                {
+                    installedBytes = GetFileBytes(PrepareEntryPath(installedRoot, entry.PathWithoutSegments(1), nullptr));
+                }
+                if (installedBytes == UINT64_MAX) installedBytes = 0;
+                if (st.m_uncomp_size > installedBytes) growthBytes += st.m_uncomp_size - installedBytes;
+            }
         }
 
-        // Clamp single segment length to be safe (Windows usually ~255)
-        constexpr size_t kMaxSegmentLen = 240; // headroom
-        if (seg.size() > kMaxSegmentLen)
+        plan.packageBytes = isDiff && !installedRoot.empty() ? FileUtils::GetFolderBytes(installedRoot) + growthBytes : plan.contentBytes;
+        return plan;
+    }
+
+    static IAsyncAction WriteSmallFileBatchAsync(std::unique_ptr<SmallFileBatch> batch, CodePushExtractionJournal* journal)
+    {
+        co_await CodePushExecutor::Resume(CodePushPriority::Normal);
+
+        for (auto const& entry : batch->entries)
         {
-            seg.resize(kMaxSegmentLen);
-            TrimTrailingDotsAndSpaces(seg);
-            if (seg.empty()) return false;
+            file_handle file{ ::CreateFile2(entry.path.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr) };
+            DWORD bytesWritten = 0;
+            if (!file ||
+                !::WriteFile(file.get(), batch->slab.data() + entry.offset, static_cast<DWORD>(entry.size), &bytesWritten, nullptr) ||
+                bytesWritten != entry.size)
+            {
+                wchar_t hrHex[11]{};
+                _snwprintf_s(hrHex, _countof(hrHex), _TRUNCATE, L"0x%08X", static_cast<uint32_t>(HRESULT_FROM_WIN32(::GetLastError())));
+                CodePushUtils::Log(L"[Unzip] Write failed: " + hstring{ entry.path } + L" hr=" + hstring{ hrHex });
+            }
+            else if (journal)
+            {
+                journal->RecordEntry(entry.index);
+            }
         }
 
-        return true;
+        CodePushUtils::Log(L"[Unzip] Small files written: " + to_hstring(batch->entries.size()));
     }
 
-    // -------------------- path building helpers --------------------
-    static std::vector<hstring> SplitPathSegments(hstring const& pathLike)
+    // -------------------- streamed, checkpointed inflate --------------------
+    // Deflated entries from this size up are inflated through a 32 KB window straight into their file
+    // rather than into a heap copy of the whole entry, which is also what lets them be checkpointed.
+    constexpr size_t kStreamedEntryBytes = size_t(4) * 1024 * 1024;
+
+    // Returns the entry's compressed bytes inside the in-memory archive, or an empty view.
+    static std::basic_string_view<uint8_t> GetCompressedData(std::vector<uint8_t> const& zipData, mz_zip_archive_file_stat const& st)
     {
-        std::vector<hstring> parts;
-        std::wstring p(pathLike.c_str());
-        std::replace(p.begin(), p.end(), L'\\', L'/');
-        size_t start = 0;
-        for (size_t i = 0; i <= p.size(); ++i)
+        constexpr size_t kLocalHeaderSize = 30;
+        constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+        auto read = [&](size_t offset, size_t size) {
+            uint32_t value = 0;
+            std::memcpy(&value, zipData.data() + offset, size);
+            return value;
+        };
+
+        const auto headerOffset = static_cast<size_t>(st.m_local_header_ofs);
+        if (headerOffset + kLocalHeaderSize > zipData.size() || read(headerOffset, 4) != kLocalHeaderSignature) return {};
+
+        const auto dataOffset = headerOffset + kLocalHeaderSize + read(headerOffset + 26, 2) + read(headerOffset + 28, 2);
+        if (dataOffset > zipData.size() || st.m_comp_size > zipData.size() - dataOffset) return {};
+        return { zipData.data() + dataOffset, static_cast<size_t>(st.m_comp_size) };
+    }
+
+    // Inflates a deflated entry into the file at path. With a journal, a checkpoint is saved every
+    // CheckpointIntervalBytes of output, and inflating resumes from the entry's checkpoint if there is one.
+    static bool InflateEntryToFile(std::basic_string_view<uint8_t> compressed, mz_zip_archive_file_stat const& st, mz_uint index,
+        std::wstring const& path, CodePushExtractionJournal* journal)
+    {
+        auto checkpoint = std::make_unique<CodePushExtractionJournal::InflateCheckpoint>();
+        bool resumed = journal && journal->TryLoadCheckpoint(index, *checkpoint) &&
+            checkpoint->inputOffset <= compressed.size() && checkpoint->outputOffset <= st.m_uncomp_size;
+
+        file_handle file{ ::CreateFile2(path.c_str(), GENERIC_WRITE, 0, resumed ? OPEN_EXISTING : CREATE_ALWAYS, nullptr) };
+        if (resumed)
         {
-            if (i == p.size() || p[i] == L'/')
+            // Drop whatever was written after the checkpoint
+            LARGE_INTEGER fileSize{}, checkpointSize{};
+            checkpointSize.QuadPart = static_cast<LONGLONG>(checkpoint->outputOffset);
+            resumed = file && ::GetFileSizeEx(file.get(), &fileSize) && fileSize.QuadPart >= checkpointSize.QuadPart &&
+                ::SetFilePointerEx(file.get(), checkpointSize, nullptr, FILE_BEGIN) && ::SetEndOfFile(file.get());
+            if (!resumed)
             {
-                if (i > start) parts.emplace_back(hstring(p.substr(start, i - start)));
-                start = i + 1;
+                file = file_handle{ ::CreateFile2(path.c_str(), GENERIC_WRITE, 0, CREATE_ALWAYS, nullptr) };
             }
         }
-        return parts;
-    }
+        if (!file) return false;
 
-    static IAsyncOperation<StorageFolder> EnsureFolderChainAsync(StorageFolder const& root,
-        std::vector<hstring> const& segments)
-    {
-        StorageFolder cur = root;
-        for (auto const& segHs : segments)
+        if (resumed)
         {
-            std::wstring segW(segHs.c_str());
-            if (!SanitizeSegment(segW)) continue;
-            cur = co_await cur.CreateFolderAsync(hstring{ segW }, CreationCollisionOption::OpenIfExists);
+            CodePushUtils::Log(L"[Unzip] Resuming entry at byte " + to_hstring(checkpoint->outputOffset) + L": " + hstring{ path });
+        }
+        else
+        {
+            std::memset(checkpoint.get(), 0, sizeof(CodePushExtractionJournal::InflateCheckpoint));
+            checkpoint->entryIndex = index;
+            checkpoint->crc32 = static_cast<uint32_t>(MZ_CRC32_INIT);
+            tinfl_init(&checkpoint->decompressor);
+        }
+
+        auto nextCheckpoint = checkpoint->outputOffset + CodePushExtractionJournal::CheckpointIntervalBytes;
+        for (;;)
+        {
+            auto inSize = static_cast<size_t>(compressed.size() - checkpoint->inputOffset);
+            size_t outSize = TINFL_LZ_DICT_SIZE - checkpoint->dictionaryOffset;
+            auto* out = checkpoint->dictionary + checkpoint->dictionaryOffset;
+            const auto status = tinfl_decompress(&checkpoint->decompressor, compressed.data() + checkpoint->inputOffset, &inSize,
+                checkpoint->dictionary, out, &outSize, 0);
+            checkpoint->inputOffset += inSize;
+
+            if (outSize > 0)
+            {
+                DWORD bytesWritten = 0;
+                if (!::WriteFile(file.get(), out, static_cast<DWORD>(outSize), &bytesWritten, nullptr) || bytesWritten != outSize) return false;
+                checkpoint->crc32 = static_cast<uint32_t>(mz_crc32(checkpoint->crc32, out, outSize));
+                checkpoint->outputOffset += outSize;
+            }
+
+            if (status != TINFL_STATUS_HAS_MORE_OUTPUT)
+            {
+                if (journal) journal->DiscardCheckpoint();
+                return status == TINFL_STATUS_DONE && checkpoint->outputOffset == st.m_uncomp_size && checkpoint->crc32 == st.m_crc32;
+            }
+
+            checkpoint->dictionaryOffset = (checkpoint->dictionaryOffset + static_cast<uint32_t>(outSize)) & (TINFL_LZ_DICT_SIZE - 1);
+            if (journal && checkpoint->outputOffset >= nextCheckpoint)
+            {
+                journal->SaveCheckpoint(*checkpoint);
+                nextCheckpoint = checkpoint->outputOffset + CodePushExtractionJournal::CheckpointIntervalBytes;
+            }
         }
-        co_return cur;
     }
 
     // -------------------- FileUtils API --------------------
 
     /*static*/ IAsyncOperation<StorageFile>
-        FileUtils::CreateFileFromPathAsync(StorageFolder rootFolder, const std::filesystem::path& relativePath)
+        FileUtils::CreateFileFromPathAsync(StorageFolder rootFolder, CodePushEntryPath entry)
     {
-        auto relPath = relativePath;
-
-        // Stack of UTF-8 segments -> we’ll sanitize as UTF-16
-        std::stack<std::string> utf8Parts;
-        utf8Parts.push(relPath.filename().string());
-        while (relPath.has_parent_path())
-        {
-            relPath = relPath.parent_path();
-            utf8Parts.push(relPath.filename().string());
-        }
-
-        // Walk folders (all but the last)
-        while (utf8Parts.size() > 1)
+        // Walk folders (all but the last segment); the segments are already sanitized
+        std::wstring_view path{ entry.Path() };
+        for (auto separator = path.find(L'\\'); separator != std::wstring_view::npos; separator = path.find(L'\\'))
         {
-            std::wstring segW = Utf8ToWide(utf8Parts.top());
-            utf8Parts.pop();
-            if (!SanitizeSegment(segW)) continue;
-
             rootFolder = co_await rootFolder.CreateFolderAsync(
-                hstring{ segW },
+                hstring{ path.substr(0, separator) },
                 CreationCollisionOption::OpenIfExists);
+            path.remove_prefix(separator + 1);
         }
 
         // Create file
-        std::wstring fileSegW = Utf8ToWide(utf8Parts.top());
-        if (!SanitizeSegment(fileSegW))
+        if (path.empty())
         {
             throw hresult_error(E_INVALIDARG, L"ZIP entry has invalid file name after sanitization.");
         }
 
         StorageFile file = co_await rootFolder.CreateFileAsync(
-            hstring{ fileSegW },
+            hstring{ path },
             CreationCollisionOption::ReplaceExisting);
 
         co_return file;
@@ -268,17 +460,67 @@ namespace Microsoft::CodePush::ReactNative
         co_return f.Name();
     }
 
+    /*static*/ fire_and_forget FileUtils::PrefetchFileAsync(hstring path, uint64_t maxBytes)
+    {
+        co_await CodePushExecutor::Resume(CodePushPriority::Idle);
+
+        file_handle file{ ::CreateFile2(path.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr) };
+        if (!file)
+        {
+            co_return;
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!::GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart == 0)
+        {
+            co_return;
+        }
+
+        const auto prefetchBytes{ static_cast<SIZE_T>((std::min<uint64_t>)(static_cast<uint64_t>(fileSize.QuadPart), maxBytes)) };
+        if (prefetchBytes == 0)
+        {
+            co_return;
+        }
+
+        handle mapping{ ::CreateFileMappingFromApp(file.get(), nullptr, PAGE_READONLY, 0, nullptr) };
+        if (!mapping)
+        {
+            co_return;
+        }
+
+        auto view{ ::MapViewOfFileFromApp(mapping.get(), FILE_MAP_READ, 0, prefetchBytes) };
+        if (view == nullptr)
+        {
+            co_return;
+        }
+
+        // The prefetched pages stay in the standby list after the view is unmapped,
+        // so the engine's own read of the bundle is served from memory.
+        WIN32_MEMORY_RANGE_ENTRY range{ view, prefetchBytes };
+        if (!::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0))
+        {
+            CodePushUtils::Log(L"[Prefetch] PrefetchVirtualMemory failed for " + path);
+        }
+
+        ::UnmapViewOfFile(view);
+        co_return;
+    }
+
     // Long-path safe unzip (from memory) + robust name sanitization
-    /*static*/ IAsyncAction
-        FileUtils::UnzipAsync(const StorageFile& zipFile, const StorageFolder& destination)
+    /*static*/ IAsyncOperation<JsonObject>
+        FileUtils::UnzipAsync(const StorageFile& zipFile, const StorageFolder& destination, hstring expectedBundleFileName, hstring journalPath,
+            JsonObject entryHashes, JsonObject installedHashes, hstring installedFolderPath, CodePushInstallReservation* reservation)
     {
+        JsonObject bundleInfo{ nullptr };
+
         // Load whole ZIP safely
         IBuffer ibuf = co_await FileIO::ReadBufferAsync(zipFile);
+        co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
         const uint32_t zipLen = ibuf ? ibuf.Length() : 0;
         CodePushUtils::Log(L"[Unzip] ZIP buffer length: " + to_hstring(zipLen));
         if (zipLen == 0) {
             CodePushUtils::Log(L"[Unzip] ZIP buffer is empty.");
-            co_return;
+            co_return bundleInfo;
         }
 
         std::vector<uint8_t> zipData(zipLen);
@@ -292,19 +534,78 @@ namespace Microsoft::CodePush::ReactNative
 
         if (!mz_zip_reader_init_mem(&za, zipData.data(), zipData.size(), 0)) {
             CodePushUtils::Log(L"[Unzip] Failed to init ZIP reader from memory.");
-            co_return;
+            co_return bundleInfo;
         }
 
         const mz_uint numFiles = mz_zip_reader_get_num_files(&za);
         CodePushUtils::Log(L"[Unzip] Number of files in ZIP: " + to_hstring(numFiles));
 
-        // Safety rails (defense-in-depth for Release)
-        constexpr size_t kMaxEntryBytes = size_t(200) * 1024 * 1024; // 200 MB per file
-        constexpr size_t kMaxTotalBytes = size_t(1024) * 1024 * 1024; // 1 GB per zip
+        // Pick up an interrupted extraction of the same archive, and record progress for the next one
+        std::unique_ptr<CodePushExtractionJournal> journal;
+        if (!journalPath.empty())
+        {
+            constexpr size_t kJournalTagBytes = size_t(64) * 1024;
+            const size_t tagBytes = (std::min)(zipData.size(), kJournalTagBytes);
+            const auto tag = static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, zipData.data() + zipData.size() - tagBytes, tagBytes));
+
+            journal = std::make_unique<CodePushExtractionJournal>();
+            if (journal->Open(std::wstring{ journalPath }, zipData.size(), tag)) {
+                bundleInfo = journal->BundleInfo();
+            }
+            else {
+                CodePushUtils::Log(L"[Unzip] Unable to open extraction journal, extraction won't be resumable.");
+                journal.reset();
+            }
+        }
+
         size_t totalOut = 0;
 
+        const std::wstring destinationRoot{ L"\\\\?\\" + std::wstring{ destination.Path() } };
+        const std::wstring installedRoot{ installedFolderPath.empty() ? std::wstring{} : L"\\\\?\\" + std::wstring{ installedFolderPath } };
+        size_t unchangedEntries = 0;
+
+        // The overlay drops a lone top-level "CodePush" folder, so that is where installed files were put
+        constexpr std::string_view kTopFolderPrefix{ "CodePush/" };
+        bool installedIsStripped = installedHashes && installedHashes.Size() > 0;
+        if (installedIsStripped)
+        {
+            for (auto const& installedEntry : installedHashes)
+            {
+                if (std::wstring_view{ installedEntry.Key() }.substr(0, kTopFolderPrefix.size()) != L"CodePush/") { installedIsStripped = false; break; }
+            }
+        }
+
+        // Fail before writing anything if the install can't fit, and hold the space it needs until it is written
+        if (reservation)
+        {
+            const auto plan = PlanExtraction(&za, journal.get(), installedRoot);
+            CodePushUtils::Log(L"[Unzip] Planned bytes: content=" + to_hstring(plan.contentBytes) + L" extract=" + to_hstring(plan.extractBytes) +
+                L" package=" + to_hstring(plan.packageBytes));
+            try
+            {
+                if (plan.contentBytes > kMaxTotalBytes)
+                {
+                    throw hresult_error(HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE), L"The update is over the size limit for a package.");
+                }
+                reservation->Reserve(plan);
+            }
+            catch (...)
+            {
+                mz_zip_reader_end(&za);
+                throw;
+            }
+        }
+
+        CreatedFolders createdFolders;
+        CodePushEntryPath entry;
+        std::unique_ptr<SmallFileBatch> smallBatch;
+        std::vector<IAsyncAction> smallBatchWrites;
+
         for (mz_uint i = 0; i < numFiles; ++i)
         {
+            // Inflating is CPU work, so it moves back to a worker after writes that completed elsewhere
+            co_await CodePushExecutor::Ensure(CodePushPriority::Normal);
+
             mz_zip_archive_file_stat st{};
             if (!mz_zip_reader_file_stat(&za, i, &st)) continue;
 
@@ -314,21 +615,21 @@ namespace Microsoft::CodePush::ReactNative
             const char* cname = st.m_filename;
             if (!cname || !*cname) continue;
 
-            // Normalize/sanitize entry name early
-            std::wstring wname = Utf8ToWide(std::string{ cname });
-            if (wname.empty()) continue;
+            // Skip absolute/odd roots like "/foo"
+            if (cname[0] == '/') continue;
 
-            // Skip absolute/odd roots like "/foo" or ".",".."
-            if (wname[0] == L'/' || wname == L"." || wname == L"..") continue;
-
-            // Convert to std::filesystem path (POSIX separators OK)
-            std::filesystem::path rel{ cname };
+            // Normalize/sanitize entry name early; names with nothing left (".", "..", "a/") are skipped
+            const hstring wname = to_hstring(std::string_view{ cname });
+            if (!entry.Parse(cname)) {
+                CodePushUtils::Log(L"[Unzip] Skipping entry with no file name: " + wname);
+                continue;
+            }
 
-            CodePushUtils::Log(L"[Unzip] Extracting: " + hstring{ wname } + L" size=" + to_hstring(st.m_uncomp_size));
+            CodePushUtils::Log(L"[Unzip] Extracting: " + wname + L" size=" + to_hstring(st.m_uncomp_size));
 
             // Size rails
             if (st.m_uncomp_size > kMaxEntryBytes) {
-                CodePushUtils::Log(L"[Unzip] Skipping oversized entry: " + hstring{ wname });
+                CodePushUtils::Log(L"[Unzip] Skipping oversized entry: " + wname);
                 continue;
             }
             if (totalOut + st.m_uncomp_size > kMaxTotalBytes) {
@@ -336,19 +637,101 @@ namespace Microsoft::CodePush::ReactNative
                 break;
             }
 
+            const std::wstring entryHash = entryHashes || installedHashes ? GetEntryHash(&za, i) : std::wstring{};
+            if (entryHashes) {
+                entryHashes.Insert(wname, JsonValue::CreateStringValue(entryHash));
+            }
+
+            // Already extracted by an interrupted run
+            if (journal && journal->IsEntryComplete(i)) {
+                totalOut += static_cast<size_t>(st.m_uncomp_size);
+                continue;
+            }
+
+            // Whichever way the entry is written below, its bytes come out of the reservation
+            if (reservation) reservation->Release(st.m_uncomp_size);
+
+            // Entries the installed package already has (other than the bundle, which is described below) are copied from it
+            if (!entryHash.empty() && installedHashes && !installedRoot.empty() && !IsEntryNamed(entry.FileName(), expectedBundleFileName) &&
+                installedHashes.GetNamedString(wname, L"") == entryHash)
+            {
+                const bool isPrefixed = installedIsStripped && std::string_view{ cname }.substr(0, kTopFolderPrefix.size()) == kTopFolderPrefix;
+                const auto installedName = isPrefixed ? entry.PathWithoutSegments(1) : entry.Path();
+
+                std::wstring path = PrepareEntryPath(destinationRoot, entry.Path(), &createdFolders);
+                if (!path.empty() && CopyUnchangedEntry(PrepareEntryPath(installedRoot, installedName, nullptr), st.m_uncomp_size, path))
+                {
+                    totalOut += static_cast<size_t>(st.m_uncomp_size);
+                    ++unchangedEntries;
+                    if (journal) journal->RecordEntry(i);
+                    continue;
+                }
+            }
+
+            // Tiny entries (other than the bundle, which is described below) are batched
+            if (st.m_uncomp_size <= kSmallEntryBytes && !IsEntryNamed(entry.FileName(), expectedBundleFileName))
+            {
+                std::wstring path = PrepareEntryPath(destinationRoot, entry.Path(), &createdFolders);
+                if (!path.empty())
+                {
+                    const auto size = static_cast<size_t>(st.m_uncomp_size);
+                    if (!smallBatch || !smallBatch->Fits(size))
+                    {
+                        if (smallBatch)
+                        {
+                            if (smallBatchWrites.size() >= kMaxSmallBatchesInFlight)
+                            {
+                                co_await smallBatchWrites.front();
+                                smallBatchWrites.erase(smallBatchWrites.begin());
+                            }
+                            smallBatchWrites.push_back(WriteSmallFileBatchAsync(std::move(smallBatch), journal.get()));
+                        }
+                        smallBatch = std::make_unique<SmallFileBatch>();
+                    }
+
+                    // The reader inflates straight from the in-memory archive into the slab, without allocating
+                    if (!mz_zip_reader_extract_to_mem(&za, i, smallBatch->slab.data() + smallBatch->used, size, 0)) {
+                        CodePushUtils::Log(L"[Unzip] Failed to extract: " + wname);
+                        continue;
+                    }
+
+                    smallBatch->entries.push_back({ i, std::move(path), smallBatch->used, size });
+                    smallBatch->used += size;
+                    totalOut += size;
+                    continue;
+                }
+            }
+
+            // Large deflated entries (other than the bundle) are inflated straight into their file
+            if (st.m_method == MZ_DEFLATED && st.m_uncomp_size >= kStreamedEntryBytes && !IsEntryNamed(entry.FileName(), expectedBundleFileName))
+            {
+                auto compressed = GetCompressedData(zipData, st);
+                std::wstring path = compressed.empty() ? std::wstring{} : PrepareEntryPath(destinationRoot, entry.Path(), &createdFolders);
+                if (!path.empty())
+                {
+                    if (InflateEntryToFile(compressed, st, i, path, journal.get())) {
+                        totalOut += static_cast<size_t>(st.m_uncomp_size);
+                        if (journal) journal->RecordEntry(i);
+                    }
+                    else {
+                        CodePushUtils::Log(L"[Unzip] Failed to extract: " + wname);
+                    }
+                    continue;
+                }
+            }
+
             // Extract whole file to heap
             size_t outSize = 0;
             void* heapData = mz_zip_reader_extract_to_heap(&za, i, &outSize, 0);
             if (!heapData) {
-                CodePushUtils::Log(L"[Unzip] Failed to extract: " + hstring{ wname });
+                CodePushUtils::Log(L"[Unzip] Failed to extract: " + wname);
                 continue;
             }
 
             try
             {
-                CodePushUtils::Log(L"[Unzip] Writing file: " + hstring{ wname });
-                // Create the destination file (sanitization happens inside)
-                StorageFile outFile = co_await CreateFileFromPathAsync(destination, rel);
+                CodePushUtils::Log(L"[Unzip] Writing file: " + wname);
+                StorageFile outFile = co_await CreateFileFromPathAsync(destination, entry);
 
                 // Write in one go (fewer async transitions, less chance to corrupt state)
                 auto rw = co_await outFile.OpenAsync(FileAccessMode::ReadWrite);
@@ -367,21 +750,53 @@ namespace Microsoft::CodePush::ReactNative
 
                 totalOut += outSize;
                 CodePushUtils::Log(L"[Unzip] File written: " + outFile.Path());
+
+                // Describe the bundle now, while its bytes are in memory, so nobody has to reopen or search for it later
+                if (bundleInfo == nullptr && !expectedBundleFileName.empty() && _wcsicmp(outFile.Name().c_str(), expectedBundleFileName.c_str()) == 0)
+                {
+                    array_view<uint8_t const> bundleData{ static_cast<uint8_t const*>(heapData), static_cast<uint32_t>(outSize) };
+                    std::wstring_view fullPath{ outFile.Path() };
+                    const auto rootLength{ destination.Path().size() + 1 };
+
+                    bundleInfo = JsonObject{};
+                    bundleInfo.Insert(CodePushPackage::RelativeBundlePathKey,
+                        JsonValue::CreateStringValue(fullPath.size() > rootLength ? fullPath.substr(rootLength) : outFile.Name()));
+                    bundleInfo.Insert(CodePushUpdateUtils::BundleFormatKey, JsonValue::CreateStringValue(
+                        CodePushUpdateUtils::IsHermesBytecode(bundleData) ? CodePushUpdateUtils::HermesBytecodeFormat : CodePushUpdateUtils::JavaScriptFormat));
+                    bundleInfo.Insert(CodePushUpdateUtils::BundleSizeKey, JsonValue::CreateNumberValue(static_cast<double>(outSize)));
+                    bundleInfo.Insert(CodePushUpdateUtils::BundleHashKey, JsonValue::CreateStringValue(CodePushUpdateUtils::ComputeHashForData(bundleData)));
+                    if (journal) journal->RecordBundleInfo(bundleInfo);
+                }
+
+                if (journal) journal->RecordEntry(i);
             }
             catch (winrt::hresult_error const& ex)
             {
                 wchar_t hrHex[11]{};
                 _snwprintf_s(hrHex, _countof(hrHex), _TRUNCATE, L"0x%08X", static_cast<uint32_t>(ex.code().value));
-                CodePushUtils::Log(L"[Unzip] Write failed: " + hstring{ wname } + L" hr=" + hstring{ hrHex });
+                CodePushUtils::Log(L"[Unzip] Write failed: " + wname + L" hr=" + hstring{ hrHex });
             }
 
             // Free heap allocation from miniz
             mz_free(heapData);
         }
 
+        if (smallBatch && !smallBatch->entries.empty())
+        {
+            smallBatchWrites.push_back(WriteSmallFileBatchAsync(std::move(smallBatch), journal.get()));
+        }
+        for (auto const& write : smallBatchWrites)
+        {
+            co_await write;
+        }
+
         mz_zip_reader_end(&za);
+        if (unchangedEntries > 0)
+        {
+            CodePushUtils::Log(L"[Unzip] Entries copied from the installed package: " + to_hstring(unchangedEntries));
+        }
         CodePushUtils::Log(L"[Unzip] Extraction complete. Total bytes: " + to_hstring(totalOut));
-        co_return;
+        co_return bundleInfo;
     }
 
 }
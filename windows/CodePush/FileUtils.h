@@ -3,26 +3,54 @@
 
 #pragma once
 
+#include "winrt/Windows.Data.Json.h"
 #include "winrt/Windows.Storage.h"
 #include "winrt/Windows.Foundation.h"
 
-#include <filesystem>
+#include <string>
 #include <string_view>
 
+#include "CodePushEntryPath.h"
+#include "CodePushInstallReservation.h"
+
 namespace Microsoft::CodePush::ReactNative
 {
 	struct FileUtils
 	{
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Storage::StorageFile> CreateFileFromPathAsync(
 			winrt::Windows::Storage::StorageFolder rootFolder, 
-			const std::filesystem::path& relativePath);
+			CodePushEntryPath entry);
 
 		static winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> FindFilePathAsync(
 			const winrt::Windows::Storage::StorageFolder& rootFolder, 
 			std::wstring_view fileName);
 
-		static winrt::Windows::Foundation::IAsyncAction UnzipAsync(
+		// The bytes in the files under folder, counted recursively.
+		static uint64_t GetFolderBytes(std::wstring const& folder);
+
+		// Maps up to maxBytes of the file and asks the OS to read it ahead on a background
+		// thread, so a later read of the file (e.g. by the JS engine) hits the file cache.
+		static winrt::fire_and_forget PrefetchFileAsync(winrt::hstring path, uint64_t maxBytes);
+
+		// Extracts the archive into destination. If an entry named expectedBundleFileName is extracted,
+		// returns its path relative to destination along with its format, size and hash (see
+		// CodePushUpdateUtils::Bundle*Key), taken from the entry while it is in memory; otherwise nullptr.
+		// With a journalPath, progress is recorded there (see CodePushExtractionJournal) and an extraction
+		// of the same archive into the same destination that was interrupted picks up where it stopped.
+		// entryHashes, if given, receives the SHA-256 each entry carries in an MZ_ZIP_EXTENSION_HASH extra
+		// field, keyed by entry name (an empty string for entries without one). Entries whose hash matches
+		// the one installedHashes has for them are copied from installedFolderPath rather than inflated.
+		// With a reservation, what the install will write is planned from the central directory and
+		// reserved before anything is written (see CodePushInstallReservation), and the extraction gives
+		// the space back as it writes; the rest is left for the caller to release.
+		static winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::Data::Json::JsonObject> UnzipAsync(
 			const winrt::Windows::Storage::StorageFile& zipFile, 
-			const winrt::Windows::Storage::StorageFolder& destination);
+			const winrt::Windows::Storage::StorageFolder& destination,
+			winrt::hstring expectedBundleFileName = {},
+			winrt::hstring journalPath = {},
+			winrt::Windows::Data::Json::JsonObject entryHashes = nullptr,
+			winrt::Windows::Data::Json::JsonObject installedHashes = nullptr,
+			winrt::hstring installedFolderPath = {},
+			CodePushInstallReservation* reservation = nullptr);
 	};
 }
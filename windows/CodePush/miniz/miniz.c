@@ -1366,12 +1366,14 @@ static int tdefl_flush_block(tdefl_compressor *d, int flush)
 
 #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES
 #ifdef MINIZ_UNALIGNED_USE_MEMCPY
+#if !(MINIZ_LITTLE_ENDIAN && MINIZ_HAS_64BIT_REGISTERS) /* only the 16-bit tdefl_find_match reads single words */
 static mz_uint16 TDEFL_READ_UNALIGNED_WORD(const mz_uint8* p)
 {
 	mz_uint16 ret;
 	memcpy(&ret, p, sizeof(mz_uint16));
 	return ret;
 }
+#endif
 static mz_uint16 TDEFL_READ_UNALIGNED_WORD2(const mz_uint16* p)
 {
 	mz_uint16 ret;
@@ -1382,6 +1384,125 @@ static mz_uint16 TDEFL_READ_UNALIGNED_WORD2(const mz_uint16* p)
 #define TDEFL_READ_UNALIGNED_WORD(p) *(const mz_uint16 *)(p)
 #define TDEFL_READ_UNALIGNED_WORD2(p) *(const mz_uint16 *)(p)
 #endif
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define TDEFL_PREFETCH(p) _mm_prefetch((const char *)(p), _MM_HINT_T0)
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+#define TDEFL_PREFETCH(p) __prefetch(p)
+#elif defined(__GNUC__) || defined(__clang__)
+#define TDEFL_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define TDEFL_PREFETCH(p) ((void)0)
+#endif
+
+#if MINIZ_LITTLE_ENDIAN && MINIZ_HAS_64BIT_REGISTERS
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static MZ_FORCEINLINE mz_uint tdefl_ctz64(mz_uint64 v)
+{
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (mz_uint)index;
+}
+#else
+#define tdefl_ctz64(v) ((mz_uint)__builtin_ctzll(v))
+#endif
+
+/* Define MINIZ_NO_SIMD_MATCH to compare 8 bytes at a time even where SSE2/NEON is available. */
+#if !defined(MINIZ_NO_SIMD_MATCH) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TDEFL_MATCH_USE_SSE2 1
+#elif !defined(MINIZ_NO_SIMD_MATCH) && (defined(__ARM_NEON) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define TDEFL_MATCH_USE_NEON 1
+#endif
+
+/* Returns the number of leading bytes p and q have in common, up to max_len. Both must be readable for max_len bytes. */
+static MZ_FORCEINLINE mz_uint tdefl_match_len(const mz_uint8 *p, const mz_uint8 *q, mz_uint max_len)
+{
+    mz_uint len = 0;
+#if defined(TDEFL_MATCH_USE_SSE2)
+    for (; len + 16 <= max_len; len += 16)
+    {
+        mz_uint mask = (mz_uint)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + len)), _mm_loadu_si128((const __m128i *)(q + len)))) ^ 0xFFFFU;
+        if (mask)
+            return len + tdefl_ctz64(mask);
+    }
+#elif defined(TDEFL_MATCH_USE_NEON)
+    for (; len + 16 <= max_len; len += 16)
+    {
+        /* Narrow the byte compare to one nibble per byte so the result fits a 64-bit mask. */
+        uint8x16_t eq = vceqq_u8(vld1q_u8(p + len), vld1q_u8(q + len));
+        mz_uint64 mask = ~vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        if (mask)
+            return len + (tdefl_ctz64(mask) >> 2);
+    }
+#endif
+    for (; len + 8 <= max_len; len += 8)
+    {
+        mz_uint64 a, b;
+        memcpy(&a, p + len, sizeof(a));
+        memcpy(&b, q + len, sizeof(b));
+        if (a != b)
+            return len + (tdefl_ctz64(a ^ b) >> 3);
+    }
+    while ((len < max_len) && (p[len] == q[len]))
+        len++;
+    return len;
+}
+
+static MZ_FORCEINLINE mz_uint16 tdefl_read_word(const mz_uint8 *p)
+{
+    mz_uint16 ret;
+    memcpy(&ret, p, sizeof(mz_uint16));
+    return ret;
+}
+
+/* Candidates are filtered on the two bytes that would extend the current best match and then compared a word (or vector) at a time, */
+/* locating the first differing byte with a count-trailing-zeros of the XOR. The search stops early once a match reaches m_nice_match_len. */
+static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahead_pos, mz_uint max_dist, mz_uint max_match_len, mz_uint *pMatch_dist, mz_uint *pMatch_len)
+{
+    mz_uint dist, pos = lookahead_pos & TDEFL_LZ_DICT_SIZE_MASK, match_len = *pMatch_len, probe_pos = pos, next_probe_pos, probe_len;
+    mz_uint num_probes_left = d->m_max_probes[match_len >= 32];
+    mz_uint nice_match_len = MZ_MIN(max_match_len, d->m_nice_match_len);
+    const mz_uint8 *s = d->m_dict + pos;
+    mz_uint16 c01 = tdefl_read_word(s + match_len - 1);
+    MZ_ASSERT(max_match_len <= TDEFL_MAX_MATCH_LEN);
+    if (max_match_len <= match_len)
+        return;
+    for (;;)
+    {
+        for (;;)
+        {
+            if (--num_probes_left == 0)
+                return;
+#define TDEFL_PROBE                                                                             \
+    next_probe_pos = d->m_next[probe_pos];                                                      \
+    if ((!next_probe_pos) || ((dist = (mz_uint16)(lookahead_pos - next_probe_pos)) > max_dist)) \
+        return;                                                                                 \
+    probe_pos = next_probe_pos & TDEFL_LZ_DICT_SIZE_MASK;                                       \
+    TDEFL_PREFETCH(&d->m_next[probe_pos]);                                                      \
+    if (tdefl_read_word(&d->m_dict[probe_pos + match_len - 1]) == c01)                          \
+        break;
+            TDEFL_PROBE;
+            TDEFL_PROBE;
+            TDEFL_PROBE;
+        }
+        if (!dist)
+            break;
+        probe_len = tdefl_match_len(s, d->m_dict + probe_pos, max_match_len);
+        if (probe_len > match_len)
+        {
+            *pMatch_dist = dist;
+            if ((*pMatch_len = match_len = probe_len) >= nice_match_len)
+                return;
+            c01 = tdefl_read_word(s + match_len - 1);
+        }
+    }
+}
+#elif MINIZ_USE_UNALIGNED_LOADS_AND_STORES
 static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahead_pos, mz_uint max_dist, mz_uint max_match_len, mz_uint *pMatch_dist, mz_uint *pMatch_len)
 {
     mz_uint dist, pos = lookahead_pos & TDEFL_LZ_DICT_SIZE_MASK, match_len = *pMatch_len, probe_pos = pos, next_probe_pos, probe_len;
@@ -1478,7 +1599,7 @@ static MZ_FORCEINLINE void tdefl_find_match(tdefl_compressor *d, mz_uint lookahe
         }
     }
 }
-#endif /* #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES */
+#endif /* #if MINIZ_LITTLE_ENDIAN && MINIZ_HAS_64BIT_REGISTERS */
 
 #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
 #ifdef MINIZ_UNALIGNED_USE_MEMCPY
@@ -1708,6 +1829,107 @@ static MZ_FORCEINLINE void tdefl_record_match(tdefl_compressor *d, mz_uint match
         d->m_huff_count[0][s_tdefl_len_sym[match_len - TDEFL_MIN_MATCH_LEN]]++;
 }
 
+/* Returns 16 * log2(x) (x > 0), linearly interpolated between powers of two. */
+static mz_uint tdefl_opt_log2_x16(mz_uint32 x)
+{
+    mz_uint bits = 0;
+    while ((x >> bits) > 1)
+        bits++;
+    return (bits << 4) + (mz_uint)((((mz_uint64)x << 4) >> bits) - 16);
+}
+
+/* Fills pCosts with the estimated cost of each symbol in 1/16 bits. Symbol frequencies of the block being built are used */
+/* once there are enough of them; before that the code lengths of the previous block are used, or the static Huffman */
+/* code lengths before the first block. */
+static void tdefl_opt_build_costs(tdefl_compressor *d, mz_uint table, mz_uint num_syms, mz_uint16 *pCosts)
+{
+    mz_uint i;
+    mz_uint32 total = 0;
+    for (i = 0; i < num_syms; i++)
+        total += d->m_huff_count[table][i];
+    if (total >= 1024)
+    {
+        mz_uint total_log2 = tdefl_opt_log2_x16(total);
+        for (i = 0; i < num_syms; i++)
+            pCosts[i] = (mz_uint16)(total_log2 - (d->m_huff_count[table][i] ? tdefl_opt_log2_x16(d->m_huff_count[table][i]) : 0) + 16);
+    }
+    else if (d->m_block_index)
+    {
+        for (i = 0; i < num_syms; i++)
+            pCosts[i] = (mz_uint16)((d->m_huff_code_sizes[table][i] ? d->m_huff_code_sizes[table][i] : 15) << 4);
+    }
+    else
+    {
+        for (i = 0; i < num_syms; i++)
+            pCosts[i] = (mz_uint16)((table == 1) ? (5 << 4) : (((i <= 143) ? 8 : ((i <= 255) ? 9 : ((i <= 279) ? 7 : 8))) << 4));
+    }
+}
+
+static MZ_FORCEINLINE mz_uint tdefl_opt_match_cost(const mz_uint16 *pLit_costs, const mz_uint16 *pDist_costs, mz_uint match_len, mz_uint match_dist)
+{
+    mz_uint len_ofs = match_len - TDEFL_MIN_MATCH_LEN, dist_ofs = match_dist - 1;
+    mz_uint dist_sym = (dist_ofs < 512) ? s_tdefl_small_dist_sym[dist_ofs] : s_tdefl_large_dist_sym[(dist_ofs >> 8) & 127];
+    mz_uint dist_extra = (dist_ofs < 512) ? s_tdefl_small_dist_extra[dist_ofs] : s_tdefl_large_dist_extra[(dist_ofs >> 8) & 127];
+    return pLit_costs[s_tdefl_len_sym[len_ofs]] + pDist_costs[dist_sym] + ((s_tdefl_len_extra[len_ofs] + dist_extra) << 4);
+}
+
+/* Plans the literal/match steps for the front of the lookahead window by finding the longest match at every position */
+/* in the window and choosing the cheapest path through it (shorter lengths of each match are considered too). Only the */
+/* first half of the window is committed unless the window is final, so decisions near its end are revisited once more */
+/* input is available. The plan obeys the same match filters as tdefl_compress_normal. */
+static void tdefl_plan_optimal_parse(tdefl_compressor *d, mz_bool final_window)
+{
+    mz_uint16 match_len[TDEFL_MAX_MATCH_LEN], match_dist[TDEFL_MAX_MATCH_LEN], step_len[TDEFL_MAX_MATCH_LEN];
+    mz_uint16 lit_costs[TDEFL_MAX_HUFF_SYMBOLS_0], dist_costs[TDEFL_MAX_HUFF_SYMBOLS_1];
+    mz_uint32 cost[TDEFL_MAX_MATCH_LEN + 1];
+    mz_uint window = d->m_lookahead_size, horizon = final_window ? d->m_lookahead_size : (d->m_lookahead_size + 1) / 2;
+    mz_uint min_match_len = (d->m_flags & TDEFL_FILTER_MATCHES) ? 6 : TDEFL_MIN_MATCH_LEN;
+    mz_uint i, len;
+
+    for (i = 0; i < window; i++)
+    {
+        mz_uint pos = d->m_lookahead_pos + i, dist = 0;
+        len = TDEFL_MIN_MATCH_LEN - 1;
+        if ((window - i) >= TDEFL_MIN_MATCH_LEN)
+            tdefl_find_match(d, pos, MZ_MIN(d->m_dict_size + i, (mz_uint)TDEFL_LZ_DICT_SIZE), window - i, &dist, &len);
+        if ((!dist) || ((pos & TDEFL_LZ_DICT_SIZE_MASK) == dist) || (len < min_match_len))
+            len = 0;
+        match_len[i] = (mz_uint16)len;
+        match_dist[i] = (mz_uint16)dist;
+    }
+
+    tdefl_opt_build_costs(d, 0, TDEFL_MAX_HUFF_SYMBOLS_0, lit_costs);
+    tdefl_opt_build_costs(d, 1, TDEFL_MAX_HUFF_SYMBOLS_1, dist_costs);
+
+    cost[window] = 0;
+    for (i = window; i-- > 0;)
+    {
+        mz_uint32 best_cost = lit_costs[d->m_dict[(d->m_lookahead_pos + i) & TDEFL_LZ_DICT_SIZE_MASK]] + cost[i + 1];
+        mz_uint best_len = 1;
+        for (len = min_match_len; len <= match_len[i]; len++)
+        {
+            mz_uint32 match_cost;
+            if ((len == TDEFL_MIN_MATCH_LEN) && (match_dist[i] >= 8U * 1024U))
+                continue;
+            match_cost = tdefl_opt_match_cost(lit_costs, dist_costs, len, match_dist[i]) + cost[i + len];
+            if (match_cost < best_cost)
+            {
+                best_cost = match_cost;
+                best_len = len;
+            }
+        }
+        cost[i] = best_cost;
+        step_len[i] = (mz_uint16)best_len;
+    }
+
+    d->m_opt_num_steps = d->m_opt_next_step = 0;
+    for (i = 0; i < horizon; i += step_len[i])
+    {
+        d->m_opt_step_len[d->m_opt_num_steps] = step_len[i];
+        d->m_opt_step_dist[d->m_opt_num_steps++] = (step_len[i] > 1) ? match_dist[i] : 0;
+    }
+}
+
 static mz_bool tdefl_compress_normal(tdefl_compressor *d)
 {
     const mz_uint8 *pSrc = d->m_pSrc;
@@ -1785,6 +2007,13 @@ static mz_bool tdefl_compress_normal(tdefl_compressor *d)
                     cur_match_dist = 1;
             }
         }
+        else if (d->m_flags & TDEFL_OPTIMAL_PARSING_FLAG)
+        {
+            if (d->m_opt_next_step == d->m_opt_num_steps)
+                tdefl_plan_optimal_parse(d, flush != TDEFL_NO_FLUSH);
+            cur_match_len = d->m_opt_step_len[d->m_opt_next_step];
+            cur_match_dist = d->m_opt_step_dist[d->m_opt_next_step++];
+        }
         else
         {
             tdefl_find_match(d, d->m_lookahead_pos, d->m_dict_size, d->m_lookahead_size, &cur_match_dist, &cur_match_len);
@@ -1911,7 +2140,7 @@ tdefl_status tdefl_compress(tdefl_compressor *d, const void *pIn_buf, size_t *pI
 #if MINIZ_USE_UNALIGNED_LOADS_AND_STORES && MINIZ_LITTLE_ENDIAN
     if (((d->m_flags & TDEFL_MAX_PROBES_MASK) == 1) &&
         ((d->m_flags & TDEFL_GREEDY_PARSING_FLAG) != 0) &&
-        ((d->m_flags & (TDEFL_FILTER_MATCHES | TDEFL_FORCE_ALL_RAW_BLOCKS | TDEFL_RLE_MATCHES)) == 0))
+        ((d->m_flags & (TDEFL_FILTER_MATCHES | TDEFL_FORCE_ALL_RAW_BLOCKS | TDEFL_RLE_MATCHES | TDEFL_OPTIMAL_PARSING_FLAG)) == 0))
     {
         if (!tdefl_compress_fast(d))
             return d->m_prev_return_status;
@@ -1954,8 +2183,11 @@ tdefl_status tdefl_init(tdefl_compressor *d, tdefl_put_buf_func_ptr pPut_buf_fun
     d->m_pPut_buf_user = pPut_buf_user;
     d->m_flags = (mz_uint)(flags);
     d->m_max_probes[0] = 1 + ((flags & 0xFFF) + 2) / 3;
-    d->m_greedy_parsing = (flags & TDEFL_GREEDY_PARSING_FLAG) != 0;
+    /* Optimal parsing plans its own steps, which are recorded as they come. */
+    d->m_greedy_parsing = (flags & (TDEFL_GREEDY_PARSING_FLAG | TDEFL_OPTIMAL_PARSING_FLAG)) != 0;
     d->m_max_probes[1] = 1 + (((flags & 0xFFF) >> 2) + 2) / 3;
+    /* Like zlib's nice_length: the faster the level, the shorter the match that ends the hash chain walk. */
+    d->m_nice_match_len = ((flags & 0xFFF) <= 32) ? 32 : (((flags & 0xFFF) <= 256) ? 128 : TDEFL_MAX_MATCH_LEN);
     if (!(flags & TDEFL_NONDETERMINISTIC_PARSING_FLAG))
         MZ_CLEAR_OBJ(d->m_hash);
     d->m_lookahead_pos = d->m_lookahead_size = d->m_dict_size = d->m_total_lz_bytes = d->m_lz_code_buf_dict_pos = d->m_bits_in = 0;
@@ -1967,6 +2199,7 @@ tdefl_status tdefl_init(tdefl_compressor *d, tdefl_put_buf_func_ptr pPut_buf_fun
     d->m_pOutput_buf_end = d->m_output_buf;
     d->m_prev_return_status = TDEFL_STATUS_OKAY;
     d->m_saved_match_dist = d->m_saved_match_len = d->m_saved_lit = 0;
+    d->m_opt_num_steps = d->m_opt_next_step = 0;
     d->m_adler32 = 1;
     d->m_pIn_buf = NULL;
     d->m_pOut_buf = NULL;
@@ -2087,6 +2320,8 @@ mz_uint tdefl_create_comp_flags_from_zip_params(int level, int window_bits, int
         comp_flags |= TDEFL_FORCE_ALL_STATIC_BLOCKS;
     else if (strategy == MZ_RLE)
         comp_flags |= TDEFL_RLE_MATCHES;
+    else if (strategy == MZ_OPTIMAL_PARSING)
+        comp_flags = (comp_flags & ~TDEFL_GREEDY_PARSING_FLAG) | TDEFL_OPTIMAL_PARSING_FLAG;
 
     return comp_flags;
 }
@@ -2378,6 +2613,144 @@ extern "C" {
     }                                                                                                                               \
     MZ_MACRO_END
 
+/* Decode tables of the fixed Huffman code (RFC 1951 3.2.6), built once instead of on every fixed block. The longest */
+/* fixed literal/length code is 9 bits and every distance code is 5 bits, so the lookups repeat every 512 and 32 entries. */
+static const mz_int16 s_tinfl_fixed_lit_look_up[512] =
+    {
+      3840, 4176, 4112, 4376, 3856, 4208, 4144, 4800, 3848, 4192, 4128, 4768, 4096, 4224, 4160, 4832,
+      3844, 4184, 4120, 4752, 3860, 4216, 4152, 4816, 3852, 4200, 4136, 4784, 4104, 4232, 4168, 4848,
+      3842, 4180, 4116, 4380, 3858, 4212, 4148, 4808, 3850, 4196, 4132, 4776, 4100, 4228, 4164, 4840,
+      3846, 4188, 4124, 4760, 3862, 4220, 4156, 4824, 3854, 4204, 4140, 4792, 4108, 4236, 4172, 4856,
+      3841, 4178, 4114, 4378, 3857, 4210, 4146, 4804, 3849, 4194, 4130, 4772, 4098, 4226, 4162, 4836,
+      3845, 4186, 4122, 4756, 3861, 4218, 4154, 4820, 3853, 4202, 4138, 4788, 4106, 4234, 4170, 4852,
+      3843, 4182, 4118, 4382, 3859, 4214, 4150, 4812, 3851, 4198, 4134, 4780, 4102, 4230, 4166, 4844,
+      3847, 4190, 4126, 4764, 3863, 4222, 4158, 4828, 3855, 4206, 4142, 4796, 4110, 4238, 4174, 4860,
+      3840, 4177, 4113, 4377, 3856, 4209, 4145, 4802, 3848, 4193, 4129, 4770, 4097, 4225, 4161, 4834,
+      3844, 4185, 4121, 4754, 3860, 4217, 4153, 4818, 3852, 4201, 4137, 4786, 4105, 4233, 4169, 4850,
+      3842, 4181, 4117, 4381, 3858, 4213, 4149, 4810, 3850, 4197, 4133, 4778, 4101, 4229, 4165, 4842,
+      3846, 4189, 4125, 4762, 3862, 4221, 4157, 4826, 3854, 4205, 4141, 4794, 4109, 4237, 4173, 4858,
+      3841, 4179, 4115, 4379, 3857, 4211, 4147, 4806, 3849, 4195, 4131, 4774, 4099, 4227, 4163, 4838,
+      3845, 4187, 4123, 4758, 3861, 4219, 4155, 4822, 3853, 4203, 4139, 4790, 4107, 4235, 4171, 4854,
+      3843, 4183, 4119, 4383, 3859, 4215, 4151, 4814, 3851, 4199, 4135, 4782, 4103, 4231, 4167, 4846,
+      3847, 4191, 4127, 4766, 3863, 4223, 4159, 4830, 3855, 4207, 4143, 4798, 4111, 4239, 4175, 4862,
+      3840, 4176, 4112, 4376, 3856, 4208, 4144, 4801, 3848, 4192, 4128, 4769, 4096, 4224, 4160, 4833,
+      3844, 4184, 4120, 4753, 3860, 4216, 4152, 4817, 3852, 4200, 4136, 4785, 4104, 4232, 4168, 4849,
+      3842, 4180, 4116, 4380, 3858, 4212, 4148, 4809, 3850, 4196, 4132, 4777, 4100, 4228, 4164, 4841,
+      3846, 4188, 4124, 4761, 3862, 4220, 4156, 4825, 3854, 4204, 4140, 4793, 4108, 4236, 4172, 4857,
+      3841, 4178, 4114, 4378, 3857, 4210, 4146, 4805, 3849, 4194, 4130, 4773, 4098, 4226, 4162, 4837,
+      3845, 4186, 4122, 4757, 3861, 4218, 4154, 4821, 3853, 4202, 4138, 4789, 4106, 4234, 4170, 4853,
+      3843, 4182, 4118, 4382, 3859, 4214, 4150, 4813, 3851, 4198, 4134, 4781, 4102, 4230, 4166, 4845,
+      3847, 4190, 4126, 4765, 3863, 4222, 4158, 4829, 3855, 4206, 4142, 4797, 4110, 4238, 4174, 4861,
+      3840, 4177, 4113, 4377, 3856, 4209, 4145, 4803, 3848, 4193, 4129, 4771, 4097, 4225, 4161, 4835,
+      3844, 4185, 4121, 4755, 3860, 4217, 4153, 4819, 3852, 4201, 4137, 4787, 4105, 4233, 4169, 4851,
+      3842, 4181, 4117, 4381, 3858, 4213, 4149, 4811, 3850, 4197, 4133, 4779, 4101, 4229, 4165, 4843,
+      3846, 4189, 4125, 4763, 3862, 4221, 4157, 4827, 3854, 4205, 4141, 4795, 4109, 4237, 4173, 4859,
+      3841, 4179, 4115, 4379, 3857, 4211, 4147, 4807, 3849, 4195, 4131, 4775, 4099, 4227, 4163, 4839,
+      3845, 4187, 4123, 4759, 3861, 4219, 4155, 4823, 3853, 4203, 4139, 4791, 4107, 4235, 4171, 4855,
+      3843, 4183, 4119, 4383, 3859, 4215, 4151, 4815, 3851, 4199, 4135, 4783, 4103, 4231, 4167, 4847,
+      3847, 4191, 4127, 4767, 3863, 4223, 4159, 4831, 3855, 4207, 4143, 4799, 4111, 4239, 4175, 4863
+    };
+
+static const mz_int16 s_tinfl_fixed_dist_look_up[32] =
+    {
+      2560, 2576, 2568, 2584, 2564, 2580, 2572, 2588, 2562, 2578, 2570, 2586, 2566, 2582, 2574, 2590,
+      2561, 2577, 2569, 2585, 2565, 2581, 2573, 2589, 2563, 2579, 2571, 2587, 2567, 2583, 2575, 2591
+    };
+
+static const mz_uint8 s_tinfl_reverse_byte[256] =
+    {
+      0, 128, 64, 192, 32, 160, 96, 224, 16, 144, 80, 208, 48, 176, 112, 240,
+      8, 136, 72, 200, 40, 168, 104, 232, 24, 152, 88, 216, 56, 184, 120, 248,
+      4, 132, 68, 196, 36, 164, 100, 228, 20, 148, 84, 212, 52, 180, 116, 244,
+      12, 140, 76, 204, 44, 172, 108, 236, 28, 156, 92, 220, 60, 188, 124, 252,
+      2, 130, 66, 194, 34, 162, 98, 226, 18, 146, 82, 210, 50, 178, 114, 242,
+      10, 138, 74, 202, 42, 170, 106, 234, 26, 154, 90, 218, 58, 186, 122, 250,
+      6, 134, 70, 198, 38, 166, 102, 230, 22, 150, 86, 214, 54, 182, 118, 246,
+      14, 142, 78, 206, 46, 174, 110, 238, 30, 158, 94, 222, 62, 190, 126, 254,
+      1, 129, 65, 193, 33, 161, 97, 225, 17, 145, 81, 209, 49, 177, 113, 241,
+      9, 137, 73, 201, 41, 169, 105, 233, 25, 153, 89, 217, 57, 185, 121, 249,
+      5, 133, 69, 197, 37, 165, 101, 229, 21, 149, 85, 213, 53, 181, 117, 245,
+      13, 141, 77, 205, 45, 173, 109, 237, 29, 157, 93, 221, 61, 189, 125, 253,
+      3, 131, 67, 195, 35, 163, 99, 227, 19, 147, 83, 211, 51, 179, 115, 243,
+      11, 139, 75, 203, 43, 171, 107, 235, 27, 155, 91, 219, 59, 187, 123, 251,
+      7, 135, 71, 199, 39, 167, 103, 231, 23, 151, 87, 215, 55, 183, 119, 247,
+      15, 143, 79, 207, 47, 175, 111, 239, 31, 159, 95, 223, 63, 191, 127, 255
+    };
+
+/* Builds the fast lookup and overflow tree of pTable from its code sizes. Symbols are counting-sorted by code length */
+/* so that only used symbols are visited, and the tables are only cleared when a complete code doesn't overwrite them. */
+static mz_bool tinfl_build_huff_table(tinfl_huff_table *pTable, mz_uint table_size)
+{
+    int tree_next = -1, tree_cur;
+    mz_uint i, j, used_syms = 0, total = 0, max_code_size = 0, next_code[17], total_syms[16], sym_offset[17];
+    mz_uint16 sorted_syms[TINFL_MAX_HUFF_SYMBOLS_0];
+    MZ_CLEAR_OBJ(total_syms);
+    for (i = 0; i < table_size; ++i)
+        total_syms[pTable->m_code_size[i]]++;
+    next_code[0] = next_code[1] = 0;
+    sym_offset[1] = 0;
+    for (i = 1; i <= 15; ++i)
+    {
+        used_syms += total_syms[i];
+        next_code[i + 1] = (total = ((total + total_syms[i]) << 1));
+        sym_offset[i + 1] = sym_offset[i] + total_syms[i];
+        if (total_syms[i])
+            max_code_size = i;
+    }
+    if ((65536 != total) && (used_syms > 1))
+        return MZ_FALSE;
+
+    /* Stable, so symbols of equal length keep their canonical code order. */
+    for (i = 0; i < table_size; ++i)
+    {
+        if (pTable->m_code_size[i])
+            sorted_syms[sym_offset[pTable->m_code_size[i]]++] = (mz_uint16)i;
+    }
+
+    if ((65536 != total) || (max_code_size > TINFL_FAST_LOOKUP_BITS))
+        MZ_CLEAR_OBJ(pTable->m_look_up);
+    if (max_code_size > TINFL_FAST_LOOKUP_BITS)
+        MZ_CLEAR_OBJ(pTable->m_tree);
+
+    for (i = 0; i < used_syms; ++i)
+    {
+        mz_uint sym_index = sorted_syms[i], code_size = pTable->m_code_size[sym_index], cur_code = next_code[code_size]++;
+        mz_uint rev_code = (((mz_uint)s_tinfl_reverse_byte[cur_code & 0xFF] << 8) | s_tinfl_reverse_byte[(cur_code >> 8) & 0xFF]) >> (16 - code_size);
+        if (code_size <= TINFL_FAST_LOOKUP_BITS)
+        {
+            mz_int16 k = (mz_int16)((code_size << 9) | sym_index);
+            while (rev_code < TINFL_FAST_LOOKUP_SIZE)
+            {
+                pTable->m_look_up[rev_code] = k;
+                rev_code += (1 << code_size);
+            }
+            continue;
+        }
+        if (0 == (tree_cur = pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)]))
+        {
+            pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)] = (mz_int16)tree_next;
+            tree_cur = tree_next;
+            tree_next -= 2;
+        }
+        rev_code >>= (TINFL_FAST_LOOKUP_BITS - 1);
+        for (j = code_size; j > (TINFL_FAST_LOOKUP_BITS + 1); j--)
+        {
+            tree_cur -= ((rev_code >>= 1) & 1);
+            if (!pTable->m_tree[-tree_cur - 1])
+            {
+                pTable->m_tree[-tree_cur - 1] = (mz_int16)tree_next;
+                tree_cur = tree_next;
+                tree_next -= 2;
+            }
+            else
+                tree_cur = pTable->m_tree[-tree_cur - 1];
+        }
+        tree_cur -= ((rev_code >>= 1) & 1);
+        pTable->m_tree[-tree_cur - 1] = (mz_int16)sym_index;
+    }
+    return MZ_TRUE;
+}
+
 tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_next, size_t *pIn_buf_size, mz_uint8 *pOut_buf_start, mz_uint8 *pOut_buf_next, size_t *pOut_buf_size, const mz_uint32 decomp_flags)
 {
     static const int s_length_base[31] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258, 0, 0 };
@@ -2491,6 +2864,12 @@ tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_nex
                     *p++ = 7;
                 for (; i <= 287; ++i)
                     *p++ = 8;
+                TINFL_MEMCPY(r->m_tables[0].m_look_up, s_tinfl_fixed_lit_look_up, sizeof(s_tinfl_fixed_lit_look_up));
+                TINFL_MEMCPY(r->m_tables[0].m_look_up + 512, s_tinfl_fixed_lit_look_up, sizeof(s_tinfl_fixed_lit_look_up));
+                for (i = 0; i < TINFL_FAST_LOOKUP_SIZE; i += 32)
+                    TINFL_MEMCPY(r->m_tables[1].m_look_up + i, s_tinfl_fixed_dist_look_up, sizeof(s_tinfl_fixed_dist_look_up));
+                /* The fixed tables are complete, skip building them below. */
+                r->m_type = (mz_uint32)-1;
             }
             else
             {
@@ -2510,66 +2889,10 @@ tinfl_status tinfl_decompress(tinfl_decompressor *r, const mz_uint8 *pIn_buf_nex
             }
             for (; (int)r->m_type >= 0; r->m_type--)
             {
-                int tree_next, tree_cur;
-                tinfl_huff_table *pTable;
-                mz_uint i, j, used_syms, total, sym_index, next_code[17], total_syms[16];
-                pTable = &r->m_tables[r->m_type];
-                MZ_CLEAR_OBJ(total_syms);
-                MZ_CLEAR_OBJ(pTable->m_look_up);
-                MZ_CLEAR_OBJ(pTable->m_tree);
-                for (i = 0; i < r->m_table_sizes[r->m_type]; ++i)
-                    total_syms[pTable->m_code_size[i]]++;
-                used_syms = 0, total = 0;
-                next_code[0] = next_code[1] = 0;
-                for (i = 1; i <= 15; ++i)
-                {
-                    used_syms += total_syms[i];
-                    next_code[i + 1] = (total = ((total + total_syms[i]) << 1));
-                }
-                if ((65536 != total) && (used_syms > 1))
+                if (!tinfl_build_huff_table(&r->m_tables[r->m_type], r->m_table_sizes[r->m_type]))
                 {
                     TINFL_CR_RETURN_FOREVER(35, TINFL_STATUS_FAILED);
                 }
-                for (tree_next = -1, sym_index = 0; sym_index < r->m_table_sizes[r->m_type]; ++sym_index)
-                {
-                    mz_uint rev_code = 0, l, cur_code, code_size = pTable->m_code_size[sym_index];
-                    if (!code_size)
-                        continue;
-                    cur_code = next_code[code_size]++;
-                    for (l = code_size; l > 0; l--, cur_code >>= 1)
-                        rev_code = (rev_code << 1) | (cur_code & 1);
-                    if (code_size <= TINFL_FAST_LOOKUP_BITS)
-                    {
-                        mz_int16 k = (mz_int16)((code_size << 9) | sym_index);
-                        while (rev_code < TINFL_FAST_LOOKUP_SIZE)
-                        {
-                            pTable->m_look_up[rev_code] = k;
-                            rev_code += (1 << code_size);
-                        }
-                        continue;
-                    }
-                    if (0 == (tree_cur = pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)]))
-                    {
-                        pTable->m_look_up[rev_code & (TINFL_FAST_LOOKUP_SIZE - 1)] = (mz_int16)tree_next;
-                        tree_cur = tree_next;
-                        tree_next -= 2;
-                    }
-                    rev_code >>= (TINFL_FAST_LOOKUP_BITS - 1);
-                    for (j = code_size; j > (TINFL_FAST_LOOKUP_BITS + 1); j--)
-                    {
-                        tree_cur -= ((rev_code >>= 1) & 1);
-                        if (!pTable->m_tree[-tree_cur - 1])
-                        {
-                            pTable->m_tree[-tree_cur - 1] = (mz_int16)tree_next;
-                            tree_cur = tree_next;
-                            tree_next -= 2;
-                        }
-                        else
-                            tree_cur = pTable->m_tree[-tree_cur - 1];
-                    }
-                    tree_cur -= ((rev_code >>= 1) & 1);
-                    pTable->m_tree[-tree_cur - 1] = (mz_int16)sym_index;
-                }
                 if (r->m_type == 2)
                 {
                     for (counter = 0; counter < (r->m_table_sizes[0] + r->m_table_sizes[1]);)
@@ -3537,124 +3860,19 @@ static mz_bool mz_zip_reader_locate_header_sig(mz_zip_archive *pZip, mz_uint32 r
     return MZ_TRUE;
 }
 
-static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint flags)
+/* Indexes and sanity checks the cdir_size bytes of central directory in m_central_dir, which was read from cdir_ofs. */
+static mz_bool mz_zip_reader_index_central_dir(mz_zip_archive *pZip, mz_uint64 cdir_ofs, mz_uint cdir_size, mz_uint num_this_disk, mz_bool sort_central_dir)
 {
-    mz_uint cdir_size = 0, cdir_entries_on_this_disk = 0, num_this_disk = 0, cdir_disk_index = 0;
-    mz_uint64 cdir_ofs = 0;
-    mz_int64 cur_file_ofs = 0;
     const mz_uint8 *p;
 
-    mz_uint32 buf_u32[4096 / sizeof(mz_uint32)];
-    mz_uint8 *pBuf = (mz_uint8 *)buf_u32;
-    mz_bool sort_central_dir = ((flags & MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY) == 0);
-    mz_uint32 zip64_end_of_central_dir_locator_u32[(MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
-    mz_uint8 *pZip64_locator = (mz_uint8 *)zip64_end_of_central_dir_locator_u32;
-
-    mz_uint32 zip64_end_of_central_dir_header_u32[(MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
-    mz_uint8 *pZip64_end_of_central_dir = (mz_uint8 *)zip64_end_of_central_dir_header_u32;
-
-    mz_uint64 zip64_end_of_central_dir_ofs = 0;
-
-    /* Basic sanity checks - reject files which are too small, and check the first 4 bytes of the file to make sure a local header is there. */
-    if (pZip->m_archive_size < MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
-        return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
-
-    if (!mz_zip_reader_locate_header_sig(pZip, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE, &cur_file_ofs))
-        return mz_zip_set_error(pZip, MZ_ZIP_FAILED_FINDING_CENTRAL_DIR);
-
-    /* Read and verify the end of central directory record. */
-    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
-        return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
-
-    if (MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG)
-        return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
-
-    if (cur_file_ofs >= (MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE + MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
-    {
-        if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs - MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE, pZip64_locator, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE) == MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE)
-        {
-            if (MZ_READ_LE32(pZip64_locator + MZ_ZIP64_ECDL_SIG_OFS) == MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIG)
-            {
-                zip64_end_of_central_dir_ofs = MZ_READ_LE64(pZip64_locator + MZ_ZIP64_ECDL_REL_OFS_TO_ZIP64_ECDR_OFS);
-                if (zip64_end_of_central_dir_ofs > (pZip->m_archive_size - MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
-                    return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
-
-                if (pZip->m_pRead(pZip->m_pIO_opaque, zip64_end_of_central_dir_ofs, pZip64_end_of_central_dir, MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE) == MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE)
-                {
-                    if (MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_SIG_OFS) == MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIG)
-                    {
-                        pZip->m_pState->m_zip64 = MZ_TRUE;
-                    }
-                }
-            }
-        }
-    }
-
-    pZip->m_total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS);
-    cdir_entries_on_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
-    num_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_THIS_DISK_OFS);
-    cdir_disk_index = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS);
-    cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS);
-    cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
-
-    if (pZip->m_pState->m_zip64)
-    {
-        mz_uint32 zip64_total_num_of_disks = MZ_READ_LE32(pZip64_locator + MZ_ZIP64_ECDL_TOTAL_NUMBER_OF_DISKS_OFS);
-        mz_uint64 zip64_cdir_total_entries = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_TOTAL_ENTRIES_OFS);
-        mz_uint64 zip64_cdir_total_entries_on_this_disk = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
-        mz_uint64 zip64_size_of_end_of_central_dir_record = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_SIZE_OF_RECORD_OFS);
-        mz_uint64 zip64_size_of_central_directory = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_SIZE_OFS);
-
-        if (zip64_size_of_end_of_central_dir_record < (MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE - 12))
-            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-        if (zip64_total_num_of_disks != 1U)
-            return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
-
-        /* Check for miniz's practical limits */
-        if (zip64_cdir_total_entries > MZ_UINT32_MAX)
-            return mz_zip_set_error(pZip, MZ_ZIP_TOO_MANY_FILES);
-
-        pZip->m_total_files = (mz_uint32)zip64_cdir_total_entries;
-
-        if (zip64_cdir_total_entries_on_this_disk > MZ_UINT32_MAX)
-            return mz_zip_set_error(pZip, MZ_ZIP_TOO_MANY_FILES);
-
-        cdir_entries_on_this_disk = (mz_uint32)zip64_cdir_total_entries_on_this_disk;
-
-        /* Check for miniz's current practical limits (sorry, this should be enough for millions of files) */
-        if (zip64_size_of_central_directory > MZ_UINT32_MAX)
-            return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_CDIR_SIZE);
-
-        cdir_size = (mz_uint32)zip64_size_of_central_directory;
-
-        num_this_disk = MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_NUM_THIS_DISK_OFS);
-
-        cdir_disk_index = MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_NUM_DISK_CDIR_OFS);
-
-        cdir_ofs = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_OFS_OFS);
-    }
-
-    if (pZip->m_total_files != cdir_entries_on_this_disk)
-        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
-
-    if (((num_this_disk | cdir_disk_index) != 0) && ((num_this_disk != 1) || (cdir_disk_index != 1)))
-        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
-
-    if (cdir_size < pZip->m_total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
+    if (cdir_size < (mz_uint64)pZip->m_total_files * MZ_ZIP_CENTRAL_DIR_HEADER_SIZE)
         return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
 
-    if ((cdir_ofs + (mz_uint64)cdir_size) > pZip->m_archive_size)
-        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
-
-    pZip->m_central_directory_file_ofs = cdir_ofs;
-
     if (pZip->m_total_files)
     {
         mz_uint i, n;
-        /* Read the entire central directory into a heap block, and allocate another heap block to hold the unsorted central dir file record offsets, and possibly another to hold the sorted indices. */
-        if ((!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, cdir_size, MZ_FALSE)) ||
-            (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir_offsets, pZip->m_total_files, MZ_FALSE)))
+        /* Allocate a heap block to hold the unsorted central dir file record offsets, and possibly another to hold the sorted indices. */
+        if (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir_offsets, pZip->m_total_files, MZ_FALSE))
             return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
 
         if (sort_central_dir)
@@ -3663,9 +3881,6 @@ static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint flag
                 return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
         }
 
-        if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, cdir_size) != cdir_size)
-            return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
-
         /* Now create an index into the central directory file records, do some basic sanity checking on each record */
         p = (const mz_uint8 *)pZip->m_pState->m_central_dir.m_p;
         for (n = cdir_size, i = 0; i < pZip->m_total_files; ++i)
@@ -3789,6 +4004,173 @@ static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint flag
     return MZ_TRUE;
 }
 
+/* Replaces a compressed central directory (see MZ_ZIP_EXTENSION_CDCD), which at this point is the archive's only entry, with the one it holds. */
+/* Archives whose only entry isn't one are left as they are. */
+static mz_bool mz_zip_reader_unzip_central_dir(mz_zip_archive *pZip, mz_uint num_this_disk, mz_bool sort_central_dir)
+{
+    mz_zip_archive_file_stat stat;
+    const mz_uint8 *pField;
+    mz_uint field_size;
+    mz_uint64 num_entries;
+    size_t cdir_size = 0;
+    void *pCentral_dir;
+
+    if ((!mz_zip_reader_file_stat(pZip, 0, &stat)) || (strcmp(stat.m_filename, MZ_ZIP_CD_FILENAME) != 0) ||
+        (!mz_zip_reader_get_extra_field(pZip, 0, MZ_ZIP_EXTENSION_CDCD, &pField, &field_size)) || (field_size != sizeof(mz_uint64)))
+    {
+        pZip->m_last_error = MZ_ZIP_NO_ERROR;
+        return MZ_TRUE;
+    }
+
+    num_entries = MZ_READ_LE64(pField);
+    if (num_entries > MZ_UINT32_MAX)
+        return mz_zip_set_error(pZip, MZ_ZIP_TOO_MANY_FILES);
+    if (stat.m_uncomp_size > MZ_UINT32_MAX)
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_CDIR_SIZE);
+
+    /* Inflated (and CRC checked) through the one-entry central directory, which is then swapped for the result */
+    if (NULL == (pCentral_dir = mz_zip_reader_extract_to_heap(pZip, 0, &cdir_size, 0)))
+        return MZ_FALSE;
+
+    mz_zip_array_clear(pZip, &pZip->m_pState->m_central_dir);
+    MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir, sizeof(mz_uint8));
+    pZip->m_pState->m_central_dir.m_p = pCentral_dir;
+    pZip->m_pState->m_central_dir.m_size = pZip->m_pState->m_central_dir.m_capacity = cdir_size;
+
+    /* Entries added by a writer opened from this reader overwrite the compressed central directory */
+    pZip->m_central_directory_file_ofs = stat.m_local_header_ofs;
+    pZip->m_total_files = (mz_uint32)num_entries;
+
+    return mz_zip_reader_index_central_dir(pZip, stat.m_local_header_ofs, (mz_uint)cdir_size, num_this_disk, sort_central_dir);
+}
+
+static mz_bool mz_zip_reader_read_central_dir(mz_zip_archive *pZip, mz_uint flags)
+{
+    mz_uint cdir_size = 0, cdir_entries_on_this_disk = 0, num_this_disk = 0, cdir_disk_index = 0;
+    mz_uint64 cdir_ofs = 0;
+    mz_int64 cur_file_ofs = 0;
+
+    mz_uint32 buf_u32[4096 / sizeof(mz_uint32)];
+    mz_uint8 *pBuf = (mz_uint8 *)buf_u32;
+    mz_bool sort_central_dir = ((flags & MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY) == 0);
+    mz_uint32 zip64_end_of_central_dir_locator_u32[(MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
+    mz_uint8 *pZip64_locator = (mz_uint8 *)zip64_end_of_central_dir_locator_u32;
+
+    mz_uint32 zip64_end_of_central_dir_header_u32[(MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE + sizeof(mz_uint32) - 1) / sizeof(mz_uint32)];
+    mz_uint8 *pZip64_end_of_central_dir = (mz_uint8 *)zip64_end_of_central_dir_header_u32;
+
+    mz_uint64 zip64_end_of_central_dir_ofs = 0;
+
+    /* Basic sanity checks - reject files which are too small, and check the first 4 bytes of the file to make sure a local header is there. */
+    if (pZip->m_archive_size < MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
+        return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
+
+    if (!mz_zip_reader_locate_header_sig(pZip, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE, &cur_file_ofs))
+        return mz_zip_set_error(pZip, MZ_ZIP_FAILED_FINDING_CENTRAL_DIR);
+
+    /* Read and verify the end of central directory record. */
+    if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs, pBuf, MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIZE)
+        return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+
+    if (MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_SIG_OFS) != MZ_ZIP_END_OF_CENTRAL_DIR_HEADER_SIG)
+        return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
+
+    if (cur_file_ofs >= (MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE + MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
+    {
+        if (pZip->m_pRead(pZip->m_pIO_opaque, cur_file_ofs - MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE, pZip64_locator, MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE) == MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIZE)
+        {
+            if (MZ_READ_LE32(pZip64_locator + MZ_ZIP64_ECDL_SIG_OFS) == MZ_ZIP64_END_OF_CENTRAL_DIR_LOCATOR_SIG)
+            {
+                zip64_end_of_central_dir_ofs = MZ_READ_LE64(pZip64_locator + MZ_ZIP64_ECDL_REL_OFS_TO_ZIP64_ECDR_OFS);
+                if (zip64_end_of_central_dir_ofs > (pZip->m_archive_size - MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE))
+                    return mz_zip_set_error(pZip, MZ_ZIP_NOT_AN_ARCHIVE);
+
+                if (pZip->m_pRead(pZip->m_pIO_opaque, zip64_end_of_central_dir_ofs, pZip64_end_of_central_dir, MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE) == MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE)
+                {
+                    if (MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_SIG_OFS) == MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIG)
+                    {
+                        pZip->m_pState->m_zip64 = MZ_TRUE;
+                    }
+                }
+            }
+        }
+    }
+
+    pZip->m_total_files = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_TOTAL_ENTRIES_OFS);
+    cdir_entries_on_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
+    num_this_disk = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_THIS_DISK_OFS);
+    cdir_disk_index = MZ_READ_LE16(pBuf + MZ_ZIP_ECDH_NUM_DISK_CDIR_OFS);
+    cdir_size = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_SIZE_OFS);
+    cdir_ofs = MZ_READ_LE32(pBuf + MZ_ZIP_ECDH_CDIR_OFS_OFS);
+
+    if (pZip->m_pState->m_zip64)
+    {
+        mz_uint32 zip64_total_num_of_disks = MZ_READ_LE32(pZip64_locator + MZ_ZIP64_ECDL_TOTAL_NUMBER_OF_DISKS_OFS);
+        mz_uint64 zip64_cdir_total_entries = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_TOTAL_ENTRIES_OFS);
+        mz_uint64 zip64_cdir_total_entries_on_this_disk = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_NUM_ENTRIES_ON_DISK_OFS);
+        mz_uint64 zip64_size_of_end_of_central_dir_record = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_SIZE_OF_RECORD_OFS);
+        mz_uint64 zip64_size_of_central_directory = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_SIZE_OFS);
+
+        if (zip64_size_of_end_of_central_dir_record < (MZ_ZIP64_END_OF_CENTRAL_DIR_HEADER_SIZE - 12))
+            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+        if (zip64_total_num_of_disks != 1U)
+            return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
+
+        /* Check for miniz's practical limits */
+        if (zip64_cdir_total_entries > MZ_UINT32_MAX)
+            return mz_zip_set_error(pZip, MZ_ZIP_TOO_MANY_FILES);
+
+        pZip->m_total_files = (mz_uint32)zip64_cdir_total_entries;
+
+        if (zip64_cdir_total_entries_on_this_disk > MZ_UINT32_MAX)
+            return mz_zip_set_error(pZip, MZ_ZIP_TOO_MANY_FILES);
+
+        cdir_entries_on_this_disk = (mz_uint32)zip64_cdir_total_entries_on_this_disk;
+
+        /* Check for miniz's current practical limits (sorry, this should be enough for millions of files) */
+        if (zip64_size_of_central_directory > MZ_UINT32_MAX)
+            return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_CDIR_SIZE);
+
+        cdir_size = (mz_uint32)zip64_size_of_central_directory;
+
+        num_this_disk = MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_NUM_THIS_DISK_OFS);
+
+        cdir_disk_index = MZ_READ_LE32(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_NUM_DISK_CDIR_OFS);
+
+        cdir_ofs = MZ_READ_LE64(pZip64_end_of_central_dir + MZ_ZIP64_ECDH_CDIR_OFS_OFS);
+    }
+
+    if (pZip->m_total_files != cdir_entries_on_this_disk)
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
+
+    if (((num_this_disk | cdir_disk_index) != 0) && ((num_this_disk != 1) || (cdir_disk_index != 1)))
+        return mz_zip_set_error(pZip, MZ_ZIP_UNSUPPORTED_MULTIDISK);
+
+    if ((cdir_ofs + (mz_uint64)cdir_size) > pZip->m_archive_size)
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+    pZip->m_central_directory_file_ofs = cdir_ofs;
+
+    if (pZip->m_total_files)
+    {
+        /* Read the entire central directory into a heap block. */
+        if (!mz_zip_array_resize(pZip, &pZip->m_pState->m_central_dir, cdir_size, MZ_FALSE))
+            return mz_zip_set_error(pZip, MZ_ZIP_ALLOC_FAILED);
+
+        if (pZip->m_pRead(pZip->m_pIO_opaque, cdir_ofs, pZip->m_pState->m_central_dir.m_p, cdir_size) != cdir_size)
+            return mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+    }
+
+    if (!mz_zip_reader_index_central_dir(pZip, cdir_ofs, cdir_size, num_this_disk, sort_central_dir))
+        return MZ_FALSE;
+
+    if ((pZip->m_total_files == 1) && ((flags & MZ_ZIP_FLAG_IGNORE_COMPRESSED_CENTRAL_DIR) == 0))
+        return mz_zip_reader_unzip_central_dir(pZip, num_this_disk, sort_central_dir);
+
+    return MZ_TRUE;
+}
+
 void mz_zip_zero_struct(mz_zip_archive *pZip)
 {
     if (pZip)
@@ -5669,6 +6051,7 @@ mz_bool mz_zip_writer_init_v2(mz_zip_archive *pZip, mz_uint64 existing_size, mz_
     MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_central_dir_offsets, sizeof(mz_uint32));
     MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pZip->m_pState->m_sorted_central_dir_offsets, sizeof(mz_uint32));
 
+    pZip->m_pState->m_init_flags = flags;
     pZip->m_pState->m_zip64 = zip64;
     pZip->m_pState->m_zip64_has_extended_info_fields = zip64;
 
@@ -6309,7 +6692,7 @@ mz_bool mz_zip_writer_add_mem_ex_v2(mz_zip_archive *pZip, const char *pArchive_n
         state.m_cur_archive_file_ofs = cur_archive_file_ofs;
         state.m_comp_size = 0;
 
-        if ((tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY) ||
+        if ((tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, (level_and_flags & MZ_ZIP_FLAG_OPTIMAL_PARSING) ? MZ_OPTIMAL_PARSING : MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY) ||
             (tdefl_compress_buffer(pComp, pBuf, buf_size, TDEFL_FINISH) != TDEFL_STATUS_DONE))
         {
             pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
@@ -6575,7 +6958,7 @@ mz_bool mz_zip_writer_add_read_buf_callback(mz_zip_archive *pZip, const char *pA
             state.m_cur_archive_file_ofs = cur_archive_file_ofs;
             state.m_comp_size = 0;
 
-            if (tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
+            if (tdefl_init(pComp, mz_zip_writer_add_put_buf_callback, &state, tdefl_create_comp_flags_from_zip_params(level, -15, (level_and_flags & MZ_ZIP_FLAG_OPTIMAL_PARSING) ? MZ_OPTIMAL_PARSING : MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
             {
                 pZip->m_pFree(pZip->m_pAlloc_opaque, pComp);
                 pZip->m_pFree(pZip->m_pAlloc_opaque, pRead_buf);
@@ -7167,6 +7550,62 @@ mz_bool mz_zip_writer_add_from_zip_reader(mz_zip_archive *pZip, mz_zip_archive *
     return MZ_TRUE;
 }
 
+/* Moves the central directory into a deflated MZ_ZIP_CD_FILENAME entry, which becomes the only record of the central directory written by */
+/* mz_zip_writer_finalize_archive(). The archive is left as it was if that wouldn't make it smaller. */
+static mz_bool mz_zip_writer_compress_central_dir(mz_zip_archive *pZip)
+{
+    mz_zip_internal_state *pState = pZip->m_pState;
+    mz_zip_array central_dir = pState->m_central_dir, central_dir_offsets = pState->m_central_dir_offsets;
+    mz_uint32 total_files = pZip->m_total_files;
+    mz_uint8 extra_data[sizeof(mz_uint16) * 2 + sizeof(mz_uint64)];
+    const size_t record_overhead = MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + sizeof(MZ_ZIP_CD_FILENAME) - 1 + sizeof(extra_data);
+    size_t comp_size = 0;
+    void *pComp;
+    mz_bool status;
+
+    if (total_files < 2)
+        return MZ_TRUE;
+
+    pComp = tdefl_compress_mem_to_heap(central_dir.m_p, central_dir.m_size, &comp_size, tdefl_create_comp_flags_from_zip_params(MZ_BEST_COMPRESSION, -15, MZ_DEFAULT_STRATEGY));
+    if ((!pComp) || ((comp_size + record_overhead * 2 + MZ_ZIP_DATA_DESCRIPTER_SIZE64) >= central_dir.m_size))
+    {
+        MZ_FREE(pComp);
+        return MZ_TRUE;
+    }
+
+    MZ_WRITE_LE16(extra_data, MZ_ZIP_EXTENSION_CDCD);
+    MZ_WRITE_LE16(extra_data + sizeof(mz_uint16), sizeof(mz_uint64));
+    MZ_WRITE_LE64(extra_data + sizeof(mz_uint16) * 2, (mz_uint64)total_files);
+
+    /* Start an empty central directory for the entry to be added to */
+    MZ_CLEAR_OBJ(pState->m_central_dir);
+    MZ_CLEAR_OBJ(pState->m_central_dir_offsets);
+    MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pState->m_central_dir, sizeof(mz_uint8));
+    MZ_ZIP_ARRAY_SET_ELEMENT_SIZE(&pState->m_central_dir_offsets, sizeof(mz_uint32));
+    pZip->m_total_files = 0;
+
+    status = mz_zip_writer_add_mem_ex_v2(pZip, MZ_ZIP_CD_FILENAME, pComp, comp_size, NULL, 0, MZ_ZIP_FLAG_COMPRESSED_DATA,
+                                         central_dir.m_size, (mz_uint32)mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)central_dir.m_p, central_dir.m_size), NULL,
+                                         (const char *)extra_data, sizeof(extra_data), (const char *)extra_data, sizeof(extra_data));
+    MZ_FREE(pComp);
+
+    if (!status)
+    {
+        /* Fall back to writing the central directory as it is */
+        mz_zip_array_clear(pZip, &pState->m_central_dir);
+        mz_zip_array_clear(pZip, &pState->m_central_dir_offsets);
+        pState->m_central_dir = central_dir;
+        pState->m_central_dir_offsets = central_dir_offsets;
+        pZip->m_total_files = total_files;
+        pZip->m_last_error = MZ_ZIP_NO_ERROR;
+        return MZ_TRUE;
+    }
+
+    mz_zip_array_clear(pZip, &central_dir);
+    mz_zip_array_clear(pZip, &central_dir_offsets);
+    return MZ_TRUE;
+}
+
 mz_bool mz_zip_writer_finalize_archive(mz_zip_archive *pZip)
 {
     mz_zip_internal_state *pState;
@@ -7178,6 +7617,9 @@ mz_bool mz_zip_writer_finalize_archive(mz_zip_archive *pZip)
 
     pState = pZip->m_pState;
 
+    if (pState->m_init_flags & MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR)
+        mz_zip_writer_compress_central_dir(pZip);
+
     if (pState->m_zip64)
     {
         if ((pZip->m_total_files > MZ_UINT32_MAX) || (pState->m_central_dir.m_size >= MZ_UINT32_MAX))
@@ -7635,6 +8077,40 @@ mz_bool mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip
     return mz_zip_file_stat_internal(pZip, file_index, mz_zip_get_cdh(pZip, file_index), pStat, NULL);
 }
 
+mz_bool mz_zip_reader_get_extra_field(mz_zip_archive *pZip, mz_uint file_index, mz_uint16 field_id, const mz_uint8 **ppData, mz_uint *pSize)
+{
+    const mz_uint8 *p = mz_zip_get_cdh(pZip, file_index);
+    const mz_uint8 *pExtra_data;
+    mz_uint32 extra_size_remaining;
+
+    if ((!p) || (!ppData) || (!pSize))
+        return mz_zip_set_error(pZip, MZ_ZIP_INVALID_PARAMETER);
+
+    extra_size_remaining = MZ_READ_LE16(p + MZ_ZIP_CDH_EXTRA_LEN_OFS);
+    pExtra_data = p + MZ_ZIP_CENTRAL_DIR_HEADER_SIZE + MZ_READ_LE16(p + MZ_ZIP_CDH_FILENAME_LEN_OFS);
+
+    while (extra_size_remaining >= sizeof(mz_uint16) * 2)
+    {
+        mz_uint32 id = MZ_READ_LE16(pExtra_data);
+        mz_uint32 field_data_size = MZ_READ_LE16(pExtra_data + sizeof(mz_uint16));
+
+        if ((field_data_size + sizeof(mz_uint16) * 2) > extra_size_remaining)
+            return mz_zip_set_error(pZip, MZ_ZIP_INVALID_HEADER_OR_CORRUPTED);
+
+        if (id == field_id)
+        {
+            *ppData = pExtra_data + sizeof(mz_uint16) * 2;
+            *pSize = field_data_size;
+            return MZ_TRUE;
+        }
+
+        pExtra_data += sizeof(mz_uint16) * 2 + field_data_size;
+        extra_size_remaining = extra_size_remaining - sizeof(mz_uint16) * 2 - field_data_size;
+    }
+
+    return MZ_FALSE;
+}
+
 mz_bool mz_zip_end(mz_zip_archive *pZip)
 {
     if (!pZip)
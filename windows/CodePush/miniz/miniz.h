@@ -215,7 +215,8 @@ enum
     MZ_FILTERED = 1,
     MZ_HUFFMAN_ONLY = 2,
     MZ_RLE = 3,
-    MZ_FIXED = 4
+    MZ_FIXED = 4,
+    MZ_OPTIMAL_PARSING = 5 /* miniz extension: very slow, near-optimal parsing (see TDEFL_OPTIMAL_PARSING_FLAG). */
 };
 
 /* Method */
@@ -594,6 +595,7 @@ enum
 /* TDEFL_FILTER_MATCHES: Discards matches <= 5 chars if enabled. */
 /* TDEFL_FORCE_ALL_STATIC_BLOCKS: Disable usage of optimized Huffman tables. */
 /* TDEFL_FORCE_ALL_RAW_BLOCKS: Only use raw (uncompressed) deflate blocks. */
+/* TDEFL_OPTIMAL_PARSING_FLAG: Choose literals and matches by minimizing the estimated bit cost over the whole lookahead window instead of lazy matching. Much slower; intended for building packages offline. The output is ordinary deflate. */
 /* The low 12 bits are reserved to control the max # of hash probes per dictionary lookup (see TDEFL_MAX_PROBES_MASK). */
 enum
 {
@@ -604,7 +606,8 @@ enum
     TDEFL_RLE_MATCHES = 0x10000,
     TDEFL_FILTER_MATCHES = 0x20000,
     TDEFL_FORCE_ALL_STATIC_BLOCKS = 0x40000,
-    TDEFL_FORCE_ALL_RAW_BLOCKS = 0x80000
+    TDEFL_FORCE_ALL_RAW_BLOCKS = 0x80000,
+    TDEFL_OPTIMAL_PARSING_FLAG = 0x100000
 };
 
 /* High level compression functions: */
@@ -699,12 +702,14 @@ typedef struct
 {
     tdefl_put_buf_func_ptr m_pPut_buf_func;
     void *m_pPut_buf_user;
-    mz_uint m_flags, m_max_probes[2];
+    mz_uint m_flags, m_max_probes[2], m_nice_match_len;
     int m_greedy_parsing;
     mz_uint m_adler32, m_lookahead_pos, m_lookahead_size, m_dict_size;
     mz_uint8 *m_pLZ_code_buf, *m_pLZ_flags, *m_pOutput_buf, *m_pOutput_buf_end;
     mz_uint m_num_flags_left, m_total_lz_bytes, m_lz_code_buf_dict_pos, m_bits_in, m_bit_buffer;
     mz_uint m_saved_match_dist, m_saved_match_len, m_saved_lit, m_output_flush_ofs, m_output_flush_remaining, m_finished, m_block_index, m_wants_to_finish;
+    mz_uint m_opt_num_steps, m_opt_next_step;
+    mz_uint16 m_opt_step_len[TDEFL_MAX_MATCH_LEN], m_opt_step_dist[TDEFL_MAX_MATCH_LEN];
     tdefl_status m_prev_return_status;
     const void *m_pIn_buf;
     void *m_pOut_buf;
@@ -920,6 +925,21 @@ enum
     MZ_ZIP_MAX_ARCHIVE_FILE_COMMENT_SIZE = 512
 };
 
+/* Extra field carrying a digest of an entry's uncompressed data, in minizip-ng's layout: */
+/* a 16-bit algorithm id, a 16-bit digest size, then the digest. */
+/* Compressed central directories also follow minizip-ng: the archive's central directory holds a single */
+/* MZ_ZIP_CD_FILENAME entry, whose data is the real central directory and whose MZ_ZIP_EXTENSION_CDCD */
+/* field holds the 64-bit number of entries in it. Readers that don't know the scheme see that one entry. */
+#define MZ_ZIP_CD_FILENAME "__cdcd__"
+
+enum
+{
+    MZ_ZIP_EXTENSION_CDCD = 0xcdcd,
+    MZ_ZIP_EXTENSION_HASH = 0x1a51,
+    MZ_ZIP_HASH_ALGORITHM_SHA256 = 23,
+    MZ_ZIP_HASH_SHA256_SIZE = 32
+};
+
 typedef struct
 {
     /* Central directory file index. */
@@ -999,7 +1019,10 @@ typedef enum {
     MZ_ZIP_FLAG_VALIDATE_HEADERS_ONLY = 0x2000,     /* validate the local headers, but don't decompress the entire file and check the crc32 */
     MZ_ZIP_FLAG_WRITE_ZIP64 = 0x4000,               /* always use the zip64 file format, instead of the original zip file format with automatic switch to zip64. Use as flags parameter with mz_zip_writer_init*_v2 */
     MZ_ZIP_FLAG_WRITE_ALLOW_READING = 0x8000,
-    MZ_ZIP_FLAG_ASCII_FILENAME = 0x10000
+    MZ_ZIP_FLAG_ASCII_FILENAME = 0x10000,
+    MZ_ZIP_FLAG_OPTIMAL_PARSING = 0x20000, /* compress with MZ_OPTIMAL_PARSING; combine with level 9 or MZ_UBER_COMPRESSION */
+    MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR = 0x40000, /* writer init flag: finalize stores the central directory deflated in a MZ_ZIP_CD_FILENAME entry, when that is smaller (see MZ_ZIP_EXTENSION_CDCD) */
+    MZ_ZIP_FLAG_IGNORE_COMPRESSED_CENTRAL_DIR = 0x80000 /* reader init flag: show a compressed central directory as its single MZ_ZIP_CD_FILENAME entry instead of the entries it holds */
 } mz_zip_flags;
 
 typedef enum {
@@ -1169,6 +1192,10 @@ int mz_zip_reader_locate_file_v2(mz_zip_archive *pZip, const char *pName, const
 /* Returns detailed information about an archive file entry. */
 mz_bool mz_zip_reader_file_stat(mz_zip_archive *pZip, mz_uint file_index, mz_zip_archive_file_stat *pStat);
 
+/* Finds the extra field with the given header id (e.g. MZ_ZIP_EXTENSION_HASH) in an entry's central directory record. */
+/* On success *ppData points at the field's data inside the central directory, valid until the reader is ended. */
+mz_bool mz_zip_reader_get_extra_field(mz_zip_archive *pZip, mz_uint file_index, mz_uint16 field_id, const mz_uint8 **ppData, mz_uint *pSize);
+
 /* MZ_TRUE if the file is in zip64 format. */
 /* A file is considered zip64 if it contained a zip64 end of central directory marker, or if it contained any zip64 extended file information fields in the central directory. */
 mz_bool mz_zip_is_zip64(mz_zip_archive *pZip);
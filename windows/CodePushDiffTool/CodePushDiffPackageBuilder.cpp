@@ -0,0 +1,247 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#include "CodePushDiffPackageBuilder.h"
+#include "CodePushSha256.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Microsoft::CodePush::ReactNative
+{
+    // Header id, data size, algorithm id, digest size, digest (see MZ_ZIP_EXTENSION_HASH)
+    constexpr size_t HashFieldSize{ 4 + 4 + MZ_ZIP_HASH_SHA256_SIZE };
+
+    // An archive read through a stream rather than loaded whole, since only central directories and changed entries are read.
+    struct ArchiveReader
+    {
+        std::ifstream stream;
+        mz_zip_archive zip{};
+
+        explicit ArchiveReader(std::filesystem::path const& path) : stream{ path, std::ios::binary | std::ios::ate }
+        {
+            if (!stream)
+            {
+                throw std::runtime_error("Unable to open release package: " + path.u8string());
+            }
+
+            const auto size{ static_cast<mz_uint64>(stream.tellg()) };
+            zip.m_pRead = [](void* opaque, mz_uint64 offset, void* buffer, size_t count) -> size_t
+            {
+                auto& stream{ *static_cast<std::ifstream*>(opaque) };
+                stream.clear();
+                stream.seekg(static_cast<std::streamoff>(offset));
+                stream.read(static_cast<char*>(buffer), static_cast<std::streamsize>(count));
+                return static_cast<size_t>(stream.gcount());
+            };
+            zip.m_pIO_opaque = &stream;
+            if (!mz_zip_reader_init(&zip, size, 0))
+            {
+                throw std::runtime_error("Release package is not a valid archive: " + path.u8string());
+            }
+        }
+
+        ~ArchiveReader()
+        {
+            mz_zip_reader_end(&zip);
+        }
+
+        ArchiveReader(ArchiveReader const&) = delete;
+        ArchiveReader& operator=(ArchiveReader const&) = delete;
+    };
+
+    // Returns the digest of the entry's SHA-256 hash field, or an empty view if it doesn't have one.
+    static std::basic_string_view<uint8_t> GetEntrySha256(mz_zip_archive* zip, mz_uint index)
+    {
+        const mz_uint8* field{ nullptr };
+        mz_uint fieldSize{ 0 };
+        if (!mz_zip_reader_get_extra_field(zip, index, MZ_ZIP_EXTENSION_HASH, &field, &fieldSize) ||
+            fieldSize != 4 + MZ_ZIP_HASH_SHA256_SIZE ||
+            (field[0] | (field[1] << 8)) != MZ_ZIP_HASH_ALGORITHM_SHA256 ||
+            (field[2] | (field[3] << 8)) != MZ_ZIP_HASH_SHA256_SIZE)
+        {
+            return {};
+        }
+        return { field + 4, MZ_ZIP_HASH_SHA256_SIZE };
+    }
+
+    // Appends text (UTF-8, as entry names are) as a JSON string
+    static void AppendJsonString(std::string& json, std::string_view text)
+    {
+        json += '"';
+        for (const char ch : text)
+        {
+            if (ch == '"' || ch == '\\')
+            {
+                json += '\\';
+                json += ch;
+            }
+            else if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                char escaped[7];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+                json += escaped;
+            }
+            else
+            {
+                json += ch;
+            }
+        }
+        json += '"';
+    }
+
+    // Copies an entry that has no hash field, adding one: the entry is inflated to hash it, but its compressed data is copied as it is.
+    static bool CopyEntryWithHash(mz_zip_archive* writer, mz_zip_archive* reader, mz_uint index, mz_zip_archive_file_stat& stat)
+    {
+        if (stat.m_method != 0 && stat.m_method != MZ_DEFLATED)
+        {
+            std::fprintf(stderr, "Unsupported compression method for %s\n", stat.m_filename);
+            return false;
+        }
+
+        size_t size{ 0 };
+        std::unique_ptr<void, decltype(&mz_free)> data{ mz_zip_reader_extract_to_heap(reader, index, &size, 0), &mz_free };
+        if (!data && stat.m_uncomp_size > 0)
+        {
+            std::fprintf(stderr, "Unable to read release package entry %s\n", stat.m_filename);
+            return false;
+        }
+
+        const auto digest{ CodePushSha256::Compute(data.get(), size) };
+        static_assert(CodePushSha256::DigestSize == MZ_ZIP_HASH_SHA256_SIZE);
+        uint8_t field[HashFieldSize]{ 0x51, 0x1a, 4 + MZ_ZIP_HASH_SHA256_SIZE, 0, MZ_ZIP_HASH_ALGORITHM_SHA256, 0, MZ_ZIP_HASH_SHA256_SIZE, 0 };
+        std::copy(digest.begin(), digest.end(), field + 8);
+        const auto extra{ reinterpret_cast<const char*>(field) };
+
+        if (stat.m_method == 0)
+        {
+            return mz_zip_writer_add_mem_ex_v2(writer, stat.m_filename, data.get(), size, nullptr, 0,
+                MZ_NO_COMPRESSION, 0, 0, &stat.m_time, extra, HashFieldSize, extra, HashFieldSize);
+        }
+
+        size_t compressedSize{ 0 };
+        std::unique_ptr<void, decltype(&mz_free)> compressed{
+            mz_zip_reader_extract_to_heap(reader, index, &compressedSize, MZ_ZIP_FLAG_COMPRESSED_DATA), &mz_free };
+        return compressed && mz_zip_writer_add_mem_ex_v2(writer, stat.m_filename, compressed.get(), compressedSize, nullptr, 0,
+            MZ_ZIP_FLAG_COMPRESSED_DATA, stat.m_uncomp_size, stat.m_crc32, &stat.m_time, extra, HashFieldSize, extra, HashFieldSize);
+    }
+
+    /*static*/ CodePushDiffPackageBuilder::Result CodePushDiffPackageBuilder::Build(
+        std::filesystem::path const& basePackagePath,
+        std::filesystem::path const& newPackagePath,
+        std::filesystem::path const& diffPackagePath,
+        mz_uint flags)
+    {
+        ArchiveReader base{ basePackagePath };
+        ArchiveReader next{ newPackagePath };
+
+        std::ofstream output{ diffPackagePath, std::ios::binary | std::ios::trunc };
+        if (!output)
+        {
+            throw std::runtime_error("Unable to create diff package: " + diffPackagePath.u8string());
+        }
+
+        mz_zip_archive writer{};
+        writer.m_pWrite = [](void* opaque, mz_uint64 offset, const void* buffer, size_t count) -> size_t
+        {
+            auto& stream{ *static_cast<std::ofstream*>(opaque) };
+            stream.seekp(static_cast<std::streamoff>(offset));
+            stream.write(static_cast<const char*>(buffer), static_cast<std::streamsize>(count));
+            return stream ? count : 0;
+        };
+        writer.m_pIO_opaque = &output;
+
+        Result result{};
+        bool succeeded{ false };
+        if (mz_zip_writer_init_v2(&writer, 0, flags))
+        {
+            const std::string diffManifestName{ DiffManifestFileName };
+            const auto baseFileCount{ mz_zip_reader_get_num_files(&base.zip) };
+            std::vector<bool> baseFileKept(baseFileCount, false);
+
+            succeeded = true;
+            const auto fileCount{ mz_zip_reader_get_num_files(&next.zip) };
+            for (mz_uint i = 0; succeeded && i < fileCount; ++i)
+            {
+                mz_zip_archive_file_stat stat{};
+                if (!mz_zip_reader_file_stat(&next.zip, i, &stat))
+                {
+                    succeeded = false;
+                    break;
+                }
+                if (stat.m_is_directory || diffManifestName == stat.m_filename)
+                {
+                    continue;
+                }
+
+                const auto hash{ GetEntrySha256(&next.zip, i) };
+                const int baseIndex{ mz_zip_reader_locate_file(&base.zip, stat.m_filename, nullptr, MZ_ZIP_FLAG_CASE_SENSITIVE) };
+                if (baseIndex >= 0)
+                {
+                    baseFileKept[baseIndex] = true;
+
+                    mz_zip_archive_file_stat baseStat{};
+                    const auto baseHash{ GetEntrySha256(&base.zip, baseIndex) };
+                    if (mz_zip_reader_file_stat(&base.zip, baseIndex, &baseStat) &&
+                        baseStat.m_crc32 == stat.m_crc32 &&
+                        baseStat.m_uncomp_size == stat.m_uncomp_size &&
+                        (hash.empty() || baseHash.empty() || hash == baseHash))
+                    {
+                        ++result.unchangedEntries;
+                        continue;
+                    }
+                }
+
+                if (hash.empty())
+                {
+                    succeeded = CopyEntryWithHash(&writer, &next.zip, i, stat);
+                    ++result.hashedEntries;
+                }
+                else
+                {
+                    succeeded = mz_zip_writer_add_from_zip_reader(&writer, &next.zip, i);
+                }
+                ++result.changedEntries;
+            }
+
+            if (succeeded)
+            {
+                std::string diffManifestContent{ "{\"deletedFiles\":[" };
+                for (mz_uint i = 0; i < baseFileCount; ++i)
+                {
+                    mz_zip_archive_file_stat baseStat{};
+                    if (!baseFileKept[i] && mz_zip_reader_file_stat(&base.zip, i, &baseStat) && !baseStat.m_is_directory &&
+                        diffManifestName != baseStat.m_filename)
+                    {
+                        if (result.deletedFiles++ > 0)
+                        {
+                            diffManifestContent += ',';
+                        }
+                        AppendJsonString(diffManifestContent, baseStat.m_filename);
+                    }
+                }
+                diffManifestContent += "]}";
+                succeeded = mz_zip_writer_add_mem(&writer, diffManifestName.c_str(), diffManifestContent.data(), diffManifestContent.size(),
+                    MZ_BEST_COMPRESSION | (flags & MZ_ZIP_FLAG_OPTIMAL_PARSING)) &&
+                    mz_zip_writer_finalize_archive(&writer);
+            }
+        }
+
+        const auto error{ writer.m_last_error };
+        mz_zip_writer_end(&writer);
+        output.close();
+        if (!succeeded || !output)
+        {
+            std::error_code ignored;
+            std::filesystem::remove(diffPackagePath, ignored);
+            throw std::runtime_error(std::string{ "Unable to write diff package: " } + mz_zip_get_error_string(error));
+        }
+        return result;
+    }
+}
@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "../CodePush/miniz/miniz.h"
+
+#include <cstdint>
+#include <filesystem>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	/*
+	 * Builds the diff package that updates one release to another straight from the two release
+	 * archives, without extracting or recompressing them: entries are compared through their
+	 * central directory records (CRC-32, size and, when both carry one, the SHA-256 of an
+	 * MZ_ZIP_EXTENSION_HASH field), and changed entries are copied with their compressed data
+	 * as it is. The diff package holds those entries and a DiffManifestFileName listing the
+	 * files the new release no longer has in deletedFiles, which is what the module's
+	 * CodePushPackage::DownloadPackageAsync applies on top of the installed package.
+	 *
+	 * Every entry written carries a SHA-256 hash field (see CodePushUpdateUtils::EntryHashesFileName);
+	 * entries that don't have one in the new release are inflated once to compute it.
+	 */
+	struct CodePushDiffPackageBuilder
+	{
+		// The name CodePushPackage::DiffManifestFileName gives the manifest in the module
+		static constexpr char DiffManifestFileName[]{ "hotcodepush.json" };
+
+		struct Result
+		{
+			uint32_t changedEntries;
+			uint32_t unchangedEntries;
+			uint32_t deletedFiles;
+			uint32_t hashedEntries; // changed entries whose hash had to be computed
+		};
+
+		// Writes the diff package to diffPackagePath, replacing any file there. flags are passed to the
+		// archive writer (e.g. MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR) and used when compressing the
+		// manifest (e.g. MZ_ZIP_FLAG_OPTIMAL_PARSING). Throws std::runtime_error if either release can't
+		// be read or the diff package can't be written.
+		static Result Build(
+			std::filesystem::path const& basePackagePath,
+			std::filesystem::path const& newPackagePath,
+			std::filesystem::path const& diffPackagePath,
+			mz_uint flags = 0);
+	};
+}
@@ -0,0 +1,305 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Builds diff packages between generated releases and checks that applying one to its base release the way
+// CodePushPackage::DownloadPackageAsync does (delete deletedFiles, then overlay the entries) gives the new release.
+// Usage: CodePushDiffPackageBuilderTest <work folder>
+
+#include "CodePushDiffPackageBuilder.h"
+#include "CodePushSha256.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::CodePush::ReactNative;
+
+static int s_failures{ 0 };
+
+#define CHECK(condition) \
+    do { if (!(condition)) { std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); ++s_failures; } } while (0)
+
+struct Entry
+{
+    std::string name;
+    std::string data;
+    bool withHash;
+};
+
+struct ArchiveEntry
+{
+    std::string data;
+    std::string hash; // the digest of the entry's hash field, if it has one
+    mz_uint64 compressedSize;
+};
+
+static std::string ToString(CodePushSha256::Digest const& digest)
+{
+    return { reinterpret_cast<char const*>(digest.data()), digest.size() };
+}
+
+static std::string ToHex(std::string const& bytes)
+{
+    std::string hex;
+    char digits[3];
+    for (const unsigned char byte : bytes)
+    {
+        std::snprintf(digits, sizeof(digits), "%02x", byte);
+        hex += digits;
+    }
+    return hex;
+}
+
+static void WriteRelease(std::filesystem::path const& path, std::vector<Entry> const& entries, mz_uint flags)
+{
+    mz_zip_archive writer{};
+    if (!mz_zip_writer_init_file_v2(&writer, path.string().c_str(), 0, flags))
+    {
+        throw std::runtime_error("Unable to create " + path.string());
+    }
+
+    mz_bool written{ MZ_TRUE };
+    for (auto const& entry : entries)
+    {
+        if (entry.name.back() == '/')
+        {
+            written = written && mz_zip_writer_add_mem(&writer, entry.name.c_str(), nullptr, 0, 0);
+            continue;
+        }
+
+        uint8_t field[4 + 4 + MZ_ZIP_HASH_SHA256_SIZE]{ 0x51, 0x1a, 4 + MZ_ZIP_HASH_SHA256_SIZE, 0, MZ_ZIP_HASH_ALGORITHM_SHA256, 0, MZ_ZIP_HASH_SHA256_SIZE, 0 };
+        const auto digest{ CodePushSha256::Compute(entry.data.data(), entry.data.size()) };
+        std::memcpy(field + 8, digest.data(), digest.size());
+        const auto extra{ entry.withHash ? reinterpret_cast<char const*>(field) : nullptr };
+        const mz_uint extraSize{ entry.withHash ? static_cast<mz_uint>(sizeof(field)) : 0 };
+        written = written && mz_zip_writer_add_mem_ex_v2(&writer, entry.name.c_str(), entry.data.data(), entry.data.size(), nullptr, 0,
+            MZ_BEST_COMPRESSION | flags, 0, 0, nullptr, extra, extraSize, extra, extraSize);
+    }
+
+    written = written && mz_zip_writer_finalize_archive(&writer);
+    mz_zip_writer_end(&writer);
+    if (!written)
+    {
+        throw std::runtime_error("Unable to write " + path.string());
+    }
+}
+
+static std::map<std::string, ArchiveEntry> ReadArchive(std::filesystem::path const& path)
+{
+    mz_zip_archive reader{};
+    if (!mz_zip_reader_init_file(&reader, path.string().c_str(), 0))
+    {
+        throw std::runtime_error("Unable to read " + path.string());
+    }
+
+    std::map<std::string, ArchiveEntry> entries;
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&reader); ++i)
+    {
+        mz_zip_archive_file_stat stat{};
+        if (!mz_zip_reader_file_stat(&reader, i, &stat) || stat.m_is_directory)
+        {
+            continue;
+        }
+
+        size_t size{ 0 };
+        std::unique_ptr<void, decltype(&mz_free)> data{ mz_zip_reader_extract_to_heap(&reader, i, &size, 0), &mz_free };
+        ArchiveEntry entry{ { static_cast<char const*>(data.get()), data ? size : 0 }, {}, stat.m_comp_size };
+
+        const mz_uint8* field{ nullptr };
+        mz_uint fieldSize{ 0 };
+        if (mz_zip_reader_get_extra_field(&reader, i, MZ_ZIP_EXTENSION_HASH, &field, &fieldSize) && fieldSize == 4 + MZ_ZIP_HASH_SHA256_SIZE)
+        {
+            entry.hash.assign(reinterpret_cast<char const*>(field + 4), MZ_ZIP_HASH_SHA256_SIZE);
+        }
+        entries.emplace(stat.m_filename, std::move(entry));
+    }
+    mz_zip_reader_end(&reader);
+    return entries;
+}
+
+// The strings in the manifest's deletedFiles array (escapes as CodePushDiffPackageBuilder writes them)
+static std::vector<std::string> ParseDeletedFiles(std::string const& manifest)
+{
+    const std::string prefix{ "{\"deletedFiles\":[" };
+    if (manifest.compare(0, prefix.size(), prefix) != 0 || manifest.size() < prefix.size() + 2 || manifest.compare(manifest.size() - 2, 2, "]}") != 0)
+    {
+        throw std::runtime_error("Unexpected manifest: " + manifest);
+    }
+
+    std::vector<std::string> deletedFiles;
+    for (size_t i = prefix.size(); i < manifest.size() - 2; ++i)
+    {
+        if (manifest[i] == ',')
+        {
+            continue;
+        }
+        if (manifest[i] != '"')
+        {
+            throw std::runtime_error("Unexpected manifest: " + manifest);
+        }
+
+        std::string name;
+        for (++i; manifest[i] != '"'; ++i)
+        {
+            if (manifest[i] == '\\')
+            {
+                ++i;
+                if (manifest[i] == 'u')
+                {
+                    name += static_cast<char>(std::stoi(manifest.substr(i + 1, 4), nullptr, 16));
+                    i += 4;
+                    continue;
+                }
+            }
+            name += manifest[i];
+        }
+        deletedFiles.push_back(name);
+    }
+    return deletedFiles;
+}
+
+static void CheckRoundTrip(std::filesystem::path const& folder, std::vector<Entry> const& baseEntries, std::vector<Entry> const& newEntries,
+    mz_uint flags, CodePushDiffPackageBuilder::Result const& expected)
+{
+    const auto basePath{ folder / "base.zip" };
+    const auto newPath{ folder / "new.zip" };
+    const auto diffPath{ folder / "diff.zip" };
+    WriteRelease(basePath, baseEntries, flags);
+    WriteRelease(newPath, newEntries, flags);
+
+    const auto result{ CodePushDiffPackageBuilder::Build(basePath, newPath, diffPath, flags) };
+    CHECK(result.changedEntries == expected.changedEntries);
+    CHECK(result.unchangedEntries == expected.unchangedEntries);
+    CHECK(result.deletedFiles == expected.deletedFiles);
+    CHECK(result.hashedEntries == expected.hashedEntries);
+
+    const auto base{ ReadArchive(basePath) };
+    const auto next{ ReadArchive(newPath) };
+    auto diff{ ReadArchive(diffPath) };
+    CHECK(diff.size() == expected.changedEntries + 1);
+
+    const auto manifest{ diff.find(CodePushDiffPackageBuilder::DiffManifestFileName) };
+    CHECK(manifest != diff.end());
+    if (manifest == diff.end())
+    {
+        return;
+    }
+    const auto deletedFiles{ ParseDeletedFiles(manifest->second.data) };
+    diff.erase(manifest);
+
+    // Apply the diff package to the base release
+    std::map<std::string, std::string> applied;
+    for (auto const& [name, entry] : base)
+    {
+        applied[name] = entry.data;
+    }
+    for (auto const& name : deletedFiles)
+    {
+        CHECK(applied.erase(name) == 1);
+    }
+    for (auto const& [name, entry] : diff)
+    {
+        applied[name] = entry.data;
+
+        // Every entry carries its hash, and its compressed data is the new release's as it is
+        CHECK(entry.hash == ToString(CodePushSha256::Compute(entry.data.data(), entry.data.size())));
+        CHECK(entry.compressedSize == next.at(name).compressedSize);
+    }
+
+    CHECK(applied.size() == next.size());
+    for (auto const& [name, entry] : next)
+    {
+        const auto appliedEntry{ applied.find(name) };
+        CHECK(appliedEntry != applied.end() && appliedEntry->second == entry.data);
+    }
+}
+
+static void TestSha256()
+{
+    auto hexDigest = [](std::string const& data) { return ToHex(ToString(CodePushSha256::Compute(data.data(), data.size()))); };
+    CHECK(hexDigest("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(hexDigest("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(hexDigest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") == "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK(hexDigest(std::string(1000000, 'a')) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+static void TestRoundTrip(std::filesystem::path const& folder)
+{
+    std::string bundle;
+    for (int i = 0; i < 4000; ++i)
+    {
+        bundle += "__d(function(global, require, module, exports) { module.exports = " + std::to_string(i) + "; });\n";
+    }
+
+    const std::vector<Entry> baseEntries{
+        { "CodePush/", "", false },
+        { "CodePush/index.windows.bundle", bundle, true },
+        { "CodePush/assets/logo.png", std::string(5000, '\x7f'), false },
+        { "CodePush/assets/same.txt", "unchanged", true },
+        { "CodePush/changed.txt", "first release", true },
+        { "CodePush/rehashed.txt", "first", false },
+        { "CodePush/removed \"quoted\"\t.txt", "removed", true },
+    };
+    const std::vector<Entry> newEntries{
+        { "CodePush/", "", false },
+        { "CodePush/index.windows.bundle", bundle, true },
+        { "CodePush/assets/logo.png", std::string(5000, '\x7f'), true },    // unchanged, hash on one side only
+        { "CodePush/assets/same.txt", "unchanged", true },
+        { "CodePush/changed.txt", "second release", true },                 // changed, copied as it is
+        { "CodePush/rehashed.txt", "second", false },                        // changed, hash computed
+        { "CodePush/assets/added.png", std::string(3000, '\x01'), false },  // added, hash computed
+    };
+
+    CheckRoundTrip(folder, baseEntries, newEntries, 0, { 3, 3, 1, 2 });
+    CheckRoundTrip(folder, baseEntries, newEntries, MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR | MZ_ZIP_FLAG_OPTIMAL_PARSING, { 3, 3, 1, 2 });
+
+    // A release to itself is an empty diff
+    CheckRoundTrip(folder, newEntries, newEntries, 0, { 0, 6, 0, 0 });
+}
+
+static void TestMissingRelease(std::filesystem::path const& folder)
+{
+    const auto diffPath{ folder / "missing.zip" };
+    auto threw{ false };
+    try
+    {
+        CodePushDiffPackageBuilder::Build(folder / "does-not-exist.zip", folder / "new.zip", diffPath);
+    }
+    catch (std::runtime_error const&)
+    {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(!std::filesystem::exists(diffPath));
+}
+
+int main(int argc, char* argv[])
+{
+    const std::filesystem::path folder{ argc > 1 ? argv[1] : "test-packages" };
+    std::filesystem::create_directories(folder);
+
+    try
+    {
+        TestSha256();
+        TestRoundTrip(folder);
+        TestMissingRelease(folder);
+    }
+    catch (std::exception const& ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        ++s_failures;
+    }
+
+    if (s_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Microsoft::CodePush::ReactNative
+{
+	// SHA-256 (FIPS 180-4), so that the tool builds without a platform crypto library.
+	class CodePushSha256
+	{
+	public:
+		static constexpr size_t DigestSize{ 32 };
+		using Digest = std::array<uint8_t, DigestSize>;
+
+		static Digest Compute(void const* data, size_t size) noexcept;
+
+	private:
+		static void Transform(uint32_t state[8], uint8_t const* block) noexcept;
+	};
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Builds a diff package from two release archives (see CodePushDiffPackageBuilder):
+//
+//     CodePushDiffTool <base release.zip> <new release.zip> <diff package.zip> [--optimal] [--compressed-central-dir]
+//
+// --optimal compresses the manifest with MZ_ZIP_FLAG_OPTIMAL_PARSING, and --compressed-central-dir writes
+// the central directory deflated (MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR), which the module reads since
+// the same change. Exits with 0 once the diff package is written, 1 if it can't be built, and 2 for bad arguments.
+
+#include "CodePushDiffPackageBuilder.h"
+
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+using Microsoft::CodePush::ReactNative::CodePushDiffPackageBuilder;
+
+template <typename Char>
+static int Run(int argc, Char* argv[])
+{
+    std::vector<std::filesystem::path> paths;
+    mz_uint flags{ 0 };
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::basic_string_view<Char> argument{ argv[i] };
+        if (argument == std::filesystem::path{ "--optimal" }.native())
+        {
+            flags |= MZ_ZIP_FLAG_OPTIMAL_PARSING;
+        }
+        else if (argument == std::filesystem::path{ "--compressed-central-dir" }.native())
+        {
+            flags |= MZ_ZIP_FLAG_WRITE_COMPRESSED_CENTRAL_DIR;
+        }
+        else
+        {
+            paths.emplace_back(argument);
+        }
+    }
+
+    if (paths.size() != 3)
+    {
+        std::fprintf(stderr, "Usage: CodePushDiffTool <base release.zip> <new release.zip> <diff package.zip> [--optimal] [--compressed-central-dir]\n");
+        return 2;
+    }
+
+    try
+    {
+        const auto result{ CodePushDiffPackageBuilder::Build(paths[0], paths[1], paths[2], flags) };
+        std::printf("Diff package built: %u changed (%u hashed), %u unchanged, %u deleted.\n",
+            result.changedEntries, result.hashedEntries, result.unchangedEntries, result.deletedFiles);
+        return 0;
+    }
+    catch (std::exception const& ex)
+    {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t* argv[])
+#else
+int main(int argc, char* argv[])
+#endif
+{
+    return Run(argc, argv);
+}
@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Times building the paths of a release's entries with CodePushEntryPath and with the per-segment sanitizer it
+// replaced (LegacyEntryPath.h, whose decoder stands in for MultiByteToWideChar):
+//
+//     CodePushEntryPathBenchmark [entries] [rounds]
+//
+// The names look like a React Native release: a bundle and assets nested in node_modules folders, a few of them
+// non-ASCII. Prints the time per name for both, and exits with 1 if they don't build the same paths.
+
+#include "CodePushEntryPath.h"
+#include "LegacyEntryPath.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::CodePush::ReactNative;
+
+static std::vector<std::string> MakeNames(int count)
+{
+    static const char* const packages[]{ "react-native", "@react-navigation/elements", "react-native-vector-icons", "lottie-react-native" };
+    static const char* const folders[]{ "Libraries/LogBox/UI/LogBoxImages", "src/assets", "Fonts", "lib/module/assets", "caf\xc3\xa9/\xe6\x97\xa5\xe6\x9c\xac" };
+    static const char* const files[]{ "close", "back-icon", "chevron-left", "loader", "icon" };
+    static const char* const scales[]{ "", "@2x", "@3x" };
+
+    std::vector<std::string> names{ "CodePush/index.windows.bundle" };
+    for (int i{ 1 }; i < count; i++)
+    {
+        names.push_back(std::string{ "CodePush/assets/node_modules/" } + packages[i % 4] + "/" + folders[i % 5] + "/" +
+            files[(i / 5) % 5] + std::to_string(i) + scales[i % 3] + ".png");
+    }
+    return names;
+}
+
+template <typename Parse>
+static double TimePerName(std::vector<std::string> const& names, int rounds, Parse&& parse)
+{
+    size_t checksum{ 0 };
+    const auto start{ std::chrono::steady_clock::now() };
+    for (int round{ 0 }; round < rounds; round++)
+    {
+        for (auto const& name : names)
+        {
+            checksum += parse(name);
+        }
+    }
+    const auto elapsed{ std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() };
+
+    // Keeps the loop from being optimized away
+    if (checksum == 0)
+    {
+        std::printf("(no paths)\n");
+    }
+    return elapsed / (static_cast<double>(names.size()) * rounds);
+}
+
+int main(int argc, char* argv[])
+{
+    const auto count{ argc > 1 ? std::atoi(argv[1]) : 2000 };
+    const auto rounds{ argc > 2 ? std::atoi(argv[2]) : 200 };
+    const auto names{ MakeNames(count) };
+
+    // UnzipAsync builds every entry's path with one instance, and the legacy code with a new string per entry
+    CodePushEntryPath entry;
+    std::wstring legacyPath;
+    for (auto const& name : names)
+    {
+        if (entry.Parse(name) != Legacy::BuildEntryPath(name, legacyPath) || entry.Path() != legacyPath)
+        {
+            std::fprintf(stderr, "The implementations disagree on %s\n", name.c_str());
+            return 1;
+        }
+    }
+
+    const auto legacy{ TimePerName(names, rounds, [](std::string const& name) {
+        std::wstring path;
+        return Legacy::BuildEntryPath(name, path) ? path.size() : 0;
+    }) };
+    const auto current{ TimePerName(names, rounds, [&entry](std::string const& name) {
+        return entry.Parse(name) ? entry.Path().size() : 0;
+    }) };
+
+    std::printf("%d names x %d rounds\n", count, rounds);
+    std::printf("  per-segment sanitizer: %8.1f ns/name\n", legacy);
+    std::printf("  CodePushEntryPath:     %8.1f ns/name (%.1fx)\n", current, legacy / current);
+    return 0;
+}
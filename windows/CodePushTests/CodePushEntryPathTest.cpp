@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Checks that CodePushEntryPath builds the same path as the per-segment sanitizer it replaced (LegacyEntryPath.h)
+// for the names that matter (traversal, device names, invalid UTF-8, long segments and paths) and for random ones.
+// Usage: CodePushEntryPathTest [iterations]
+
+#include "CodePushEntryPath.h"
+#include "LegacyEntryPath.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace Microsoft::CodePush::ReactNative;
+
+static int s_failures{ 0 };
+
+#define CHECK(condition) \
+    do { if (!(condition)) { std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); ++s_failures; } } while (0)
+
+static std::string ToHex(std::string_view bytes)
+{
+    std::string hex;
+    char digits[3];
+    for (const unsigned char byte : bytes)
+    {
+        std::snprintf(digits, sizeof(digits), "%02x", byte);
+        hex += digits;
+    }
+    return hex;
+}
+
+static std::string ToHex(std::wstring_view units)
+{
+    std::string hex;
+    char digits[6];
+    for (const auto unit : units)
+    {
+        std::snprintf(digits, sizeof(digits), "%04x ", static_cast<unsigned>(unit));
+        hex += digits;
+    }
+    return hex;
+}
+
+// Parses name with path (which may hold the result of an earlier name) and compares it with the legacy path
+static bool CheckEquivalent(CodePushEntryPath& path, std::string_view name)
+{
+    std::wstring expected;
+    const auto expectedKept{ Legacy::BuildEntryPath(name, expected) };
+    const auto kept{ path.Parse(name) };
+    if (kept == expectedKept && (!kept || path.Path() == expected))
+    {
+        return true;
+    }
+
+    // Report the first mismatches only, a broken change makes most random names differ
+    static int s_reported{ 0 };
+    if (++s_reported <= 10)
+    {
+        std::fprintf(stderr, "Mismatch for name %s:\n  expected %d [%s]\n  actual   %d [%s]\n", ToHex(name).c_str(),
+            expectedKept, ToHex(std::wstring_view{ expected }).c_str(), kept, ToHex(path.Path()).c_str());
+    }
+    return false;
+}
+
+static void TestNames()
+{
+    const std::string names[]{
+        "CodePush/index.windows.bundle",
+        "CodePush/assets/node_modules/react-native/Libraries/LogBox/UI/LogBoxImages/close.png",
+        "..", "../..", "../../evil.dll", "a/./b/../c", "/abs/path", "C:/Windows/win.ini", "a\\b\\c", "a//b\\\\c",
+        "x/", "x/..", "x/ . .", "", "/", ".",
+        "CON", "con.txt", "NUL.tar.gz", "nul/aux", "COM1", "com9.js", "LPT1.", "COM0", "CONX", "xCON", "PRN .txt",
+        "a:b|c?d*e\"f<g>h", std::string{ "tab\there\x01\x1f" },
+        "trailing.", "trailing ", "trailing. .", "...name",
+        "\xff\xfe.txt", "\xc0\xaf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xf0\x9f\x98", "\xf0\x9f\x98/x",
+        "caf\xc3\xa9/\xe6\x97\xa5\xe6\x9c\xac/\xf0\x9f\x98\x80.png", "\xc3", "a\xe2\x82",
+    };
+    CodePushEntryPath path;
+    for (auto const& name : names)
+    {
+        CHECK(CheckEquivalent(path, name));
+    }
+
+    // Segments clamped to MaxSegmentLength, including clamps that end in dots or spaces or leave nothing
+    CHECK(CheckEquivalent(path, std::string(400, 'a') + "/b"));
+    CHECK(CheckEquivalent(path, std::string(239, 'a') + ".  " + std::string(20, 'b')));
+    CHECK(CheckEquivalent(path, std::string(300, '.') + "x"));
+    CHECK(CheckEquivalent(path, "dir/" + std::string(300, ' ')));
+    CHECK(CheckEquivalent(path, std::string(120, '\xff')));
+    std::string emoji;
+    for (int i{ 0 }; i < 130; i++) emoji += "\xf0\x9f\x98\x80";
+    CHECK(CheckEquivalent(path, emoji));
+
+    // Paths longer than the inline buffer, then a short one parsed with the same instance
+    std::string many;
+    for (int i{ 0 }; i < 100; i++) many += "abcd/";
+    CHECK(CheckEquivalent(path, many + "f"));
+    CHECK(path.Path().size() > CodePushEntryPath::InlineCapacity);
+    CHECK(path.FileName() == L"f");
+    CHECK(path.PathWithoutSegments(99) == L"abcd\\f");
+    CHECK(path.PathWithoutSegments(101).empty());
+    CHECK(CheckEquivalent(path, std::string(CodePushEntryPath::InlineCapacity, 'z')));
+    CHECK(CheckEquivalent(path, "short/name"));
+    CHECK(path.FileName() == L"name");
+    CHECK(path.PathWithoutSegments(1) == L"name");
+}
+
+// Random names drawn from the bytes the sanitizer treats specially, so that every rule is exercised in many
+// combinations. The seed is fixed, so a failure reproduces.
+static void TestRandomNames(int iterations)
+{
+    static const std::string_view pieces[]{
+        "/", "\\", ".", "..", " ", ":", "<", "|", "?", "*", "\"", "\x01", "\x1f",
+        "a", "b", "z", "0", "1", "9", "C", "O", "N", "n", "u", "l", "P", "R", "X", "M", "T", "c", "o", "m", "p", "t",
+        "CON", "aux", "Com", "LPT", ".js", ".txt",
+        "\xc3\xa9", "\xe6\x97\xa5", "\xf0\x9f\x98\x80", "\xef\xbf\xbd", "\xed\x9f\xbf", "\xee\x80\x80",
+        "\x80", "\xbf", "\xc0", "\xc1", "\xc2", "\xdf", "\xe0", "\xe0\xa0", "\xed", "\xed\xa0", "\xef", "\xf0",
+        "\xf0\x90", "\xf4", "\xf4\x8f\xbf", "\xf4\x90", "\xf5", "\xf8", "\xff",
+    };
+    std::mt19937 random{ 20240601 };
+    std::uniform_int_distribution<size_t> pieceIndex{ 0, std::size(pieces) - 1 };
+    std::uniform_int_distribution<int> byte{ 0, 255 };
+    std::uniform_int_distribution<int> percent{ 0, 99 };
+
+    CodePushEntryPath path;
+    std::string name;
+    for (int i{ 0 }; i < iterations; i++)
+    {
+        name.clear();
+
+        // Mostly short names, with some long enough to clamp a segment or to overflow the inline buffer
+        const auto length{ percent(random) < 90 ? percent(random) % 24 : 200 + percent(random) * 4 };
+        while (name.size() < static_cast<size_t>(length))
+        {
+            if (percent(random) < 15)
+            {
+                name.push_back(static_cast<char>(byte(random)));
+            }
+            else
+            {
+                name += pieces[pieceIndex(random)];
+            }
+        }
+        if (!CheckEquivalent(path, name))
+        {
+            ++s_failures;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const auto iterations{ argc > 1 ? std::atoi(argv[1]) : 200000 };
+
+    TestNames();
+    TestRandomNames(iterations);
+
+    if (s_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
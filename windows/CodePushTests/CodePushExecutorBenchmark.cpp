@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Measures how much install-like CPU work delays a UI thread, when that work runs on plain threads (as thread
+// pool continuations do) and when it runs as Normal work on CodePushExecutor workers:
+//
+//     CodePushExecutorBenchmark [workers]
+//
+// The UI thread renders 16 ms frames with 4 ms of work each, and the report says how late that work finishes.
+// Both runs use the same number of threads (one per core by default, so that they compete with the UI thread),
+// so the difference is the executor's lower thread priority. That priority only has an effect where
+// CodePushExecutorPlatform lowers it, i.e. on Windows and Linux.
+
+#include "CodePushExecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace Microsoft::CodePush::ReactNative;
+using namespace std::chrono_literals;
+
+static constexpr int ChunkCount{ 60 };
+static uint64_t s_iterationsPerChunk{ 10000000 };
+
+// One chunk of inflating or hashing
+static void Work()
+{
+    volatile uint64_t value{ 0 };
+    for (uint64_t i{ 0 }; i < s_iterationsPerChunk; i++)
+    {
+        value = value * 31 + i;
+    }
+}
+
+static void Spin(std::chrono::microseconds duration)
+{
+    const auto start{ std::chrono::steady_clock::now() };
+    while (std::chrono::steady_clock::now() - start < duration) {}
+}
+
+// Renders frames until stop is set, recording how late each frame's work finished in milliseconds
+static void RunUi(std::atomic<bool>& stop, std::vector<double>& lateness)
+{
+    auto frame{ std::chrono::steady_clock::now() };
+    while (!stop)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        Spin(4ms);
+        lateness.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start - 4ms).count());
+        frame += 16ms;
+        std::this_thread::sleep_until(frame);
+    }
+}
+
+template <typename Install>
+static void Measure(char const* name, Install&& install)
+{
+    std::atomic<bool> stop{ false };
+    std::vector<double> lateness;
+    std::thread ui{ RunUi, std::ref(stop), std::ref(lateness) };
+    std::this_thread::sleep_for(100ms);
+
+    const auto start{ std::chrono::steady_clock::now() };
+    install();
+    const auto installTime{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+
+    std::this_thread::sleep_for(100ms);
+    stop = true;
+    ui.join();
+
+    std::sort(lateness.begin(), lateness.end());
+    auto percentile = [&lateness](double fraction) { return lateness[static_cast<size_t>(fraction * (lateness.size() - 1))]; };
+    const auto missed{ std::count_if(lateness.begin(), lateness.end(), [](double late) { return late > 12; }) };
+    std::printf("%-28s frames=%zu p50=%.2fms p99=%.2fms max=%.2fms missed=%d install=%.0fms\n", name, lateness.size(),
+        percentile(0.5), percentile(0.99), lateness.back(), static_cast<int>(missed), installTime);
+}
+
+int main(int argc, char* argv[])
+{
+    const auto workerCount{ argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : (std::max)(std::thread::hardware_concurrency(), 1u) };
+
+    // Calibrate the chunks so that the install takes about 1.2 s of CPU time
+    const auto start{ std::chrono::steady_clock::now() };
+    Work();
+    s_iterationsPerChunk = static_cast<uint64_t>(s_iterationsPerChunk * 20.0 / std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    std::printf("%d chunks of ~20 ms on %u threads\n", ChunkCount, workerCount);
+
+    Measure("threads at normal priority", [workerCount]() {
+        std::atomic<int> next{ 0 };
+        std::vector<std::thread> threads;
+        for (unsigned i{ 0 }; i < workerCount; i++)
+        {
+            threads.emplace_back([&next]() {
+                while (next++ < ChunkCount)
+                {
+                    Work();
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    });
+
+    // Workers run until the process exits, so the executor is never destroyed
+    auto& executor{ *new CodePushExecutor(workerCount) };
+    Measure("CodePushExecutor (Normal)", [&executor]() {
+        std::atomic<int> done{ 0 };
+        for (int i{ 0 }; i < ChunkCount; i++)
+        {
+            executor.Post(CodePushPriority::Normal, [&done]() {
+                Work();
+                done++;
+            });
+        }
+        while (done < ChunkCount)
+        {
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    return 0;
+}
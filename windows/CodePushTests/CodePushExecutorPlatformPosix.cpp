@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CodePushExecutorPlatform.h for the portable tests. On Linux the Windows thread priorities are mapped to nice
+// values (normal 0, below normal 5, background 19) so that the benchmarks see the same effect; elsewhere the
+// priority is left alone. Raising a worker's priority back needs CAP_SYS_NICE, and failing to is ignored.
+
+#include "CodePushExecutorPlatform.h"
+
+#include <cstdio>
+#include <exception>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Microsoft::CodePush::ReactNative
+{
+    void ApplyWorkerPriority(CodePushPriority from, CodePushPriority to) noexcept
+    {
+        if (from == to)
+        {
+            return;
+        }
+#ifdef __linux__
+        const int nice{ to == CodePushPriority::Normal ? 5 : to == CodePushPriority::Idle ? 19 : 0 };
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice);
+#endif
+    }
+
+    void LogUnhandledWorkerError() noexcept
+    {
+        try
+        {
+            throw;
+        }
+        catch (std::exception const& ex)
+        {
+            std::fprintf(stderr, "[CodePush] Unhandled error in background work: %s\n", ex.what());
+        }
+        catch (...)
+        {
+            std::fprintf(stderr, "[CodePush] Unhandled error in background work.\n");
+        }
+    }
+}
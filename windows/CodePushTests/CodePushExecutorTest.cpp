@@ -0,0 +1,168 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Checks the order CodePushExecutor runs queued work in: highest priority first and in order within a priority,
+// except that work which has waited StarvationLimit runs ahead of higher priorities. Each test uses its own
+// executor with a single worker, so that the order is deterministic.
+
+#include "CodePushExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace Microsoft::CodePush::ReactNative;
+using namespace std::chrono_literals;
+
+static int s_failures{ 0 };
+
+#define CHECK(condition) \
+    do { if (!(condition)) { std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #condition); ++s_failures; } } while (0)
+
+// Workers run until the process exits, so test executors are never destroyed
+static CodePushExecutor& MakeSingleWorkerExecutor()
+{
+    return *new CodePushExecutor(1);
+}
+
+// Occupies the executor's worker until the returned promise is set, so that work can be queued behind it
+static std::promise<void> BlockWorker(CodePushExecutor& executor)
+{
+    auto started{ std::make_shared<std::promise<void>>() };
+    std::promise<void> release;
+    executor.Post(CodePushPriority::Normal, [started, released = release.get_future().share()]() {
+        started->set_value();
+        released.wait();
+    });
+    started->get_future().wait();
+    return release;
+}
+
+static void TestOrdering()
+{
+    auto& executor{ MakeSingleWorkerExecutor() };
+    auto release{ BlockWorker(executor) };
+
+    struct State
+    {
+        std::mutex mutex;
+        std::string order;
+        bool ranAtPriority{ true };
+        int remaining{ 6 };
+        std::promise<void> done;
+    };
+    auto state{ std::make_shared<State>() };
+
+    const std::pair<CodePushPriority, char const*> tasks[]{
+        { CodePushPriority::Idle, "I1" },
+        { CodePushPriority::Normal, "N1" },
+        { CodePushPriority::Critical, "C1" },
+        { CodePushPriority::Idle, "I2" },
+        { CodePushPriority::Normal, "N2" },
+        { CodePushPriority::Critical, "C2" },
+    };
+    for (auto const& task : tasks)
+    {
+        executor.Post(task.first, [state, priority = task.first, name = task.second]() {
+            std::lock_guard lock{ state->mutex };
+            state->ranAtPriority = state->ranAtPriority && CodePushExecutor::IsRunning(priority);
+            state->order += state->order.empty() ? name : std::string{ " " } + name;
+            if (--state->remaining == 0)
+            {
+                state->done.set_value();
+            }
+        });
+    }
+    release.set_value();
+
+    CHECK(state->done.get_future().wait_for(5s) == std::future_status::ready);
+    std::lock_guard lock{ state->mutex };
+    std::printf("Ran %s\n", state->order.c_str());
+    CHECK(state->order == "C1 C2 N1 N2 I1 I2");
+    CHECK(state->ranAtPriority);
+    CHECK(!CodePushExecutor::IsRunning(CodePushPriority::Critical));
+}
+
+static void TestStarvation()
+{
+    auto& executor{ MakeSingleWorkerExecutor() };
+
+    struct State
+    {
+        std::atomic<bool> stop{ false };
+        std::atomic<int> normalCount{ 0 };
+        std::promise<std::chrono::steady_clock::time_point> idleRan;
+    };
+    auto state{ std::make_shared<State>() };
+
+    // Normal work that never lets the queue empty: each task takes 2 ms and queues the next one
+    struct NormalWork
+    {
+        CodePushExecutor* executor;
+        std::shared_ptr<State> state;
+
+        void operator()() const
+        {
+            const auto start{ std::chrono::steady_clock::now() };
+            while (std::chrono::steady_clock::now() - start < 2ms) {}
+            state->normalCount++;
+            if (!state->stop)
+            {
+                executor->Post(CodePushPriority::Normal, *this);
+            }
+        }
+    };
+    executor.Post(CodePushPriority::Normal, NormalWork{ &executor, state });
+    executor.Post(CodePushPriority::Normal, NormalWork{ &executor, state });
+    std::this_thread::sleep_for(50ms);
+
+    const auto queued{ std::chrono::steady_clock::now() };
+    const auto normalCountBefore{ state->normalCount.load() };
+    executor.Post(CodePushPriority::Idle, [state]() { state->idleRan.set_value(std::chrono::steady_clock::now()); });
+
+    auto idleRan{ state->idleRan.get_future() };
+    const auto ran{ idleRan.wait_for(10 * CodePushExecutor::StarvationLimit) == std::future_status::ready };
+    const auto normalCountWhileWaiting{ state->normalCount.load() - normalCountBefore };
+    state->stop = true;
+
+    CHECK(ran);
+    if (ran)
+    {
+        const auto waited{ std::chrono::duration_cast<std::chrono::milliseconds>(idleRan.get() - queued) };
+        std::printf("Idle work ran after %lld ms, behind %d normal tasks\n", static_cast<long long>(waited.count()), normalCountWhileWaiting);
+        CHECK(waited >= CodePushExecutor::StarvationLimit);
+        CHECK(waited < 4 * CodePushExecutor::StarvationLimit);
+        CHECK(normalCountWhileWaiting >= 50);
+    }
+}
+
+static void TestUnhandledError()
+{
+    auto& executor{ MakeSingleWorkerExecutor() };
+    auto ranAfter{ std::make_shared<std::promise<void>>() };
+    executor.Post(CodePushPriority::Normal, []() { throw std::runtime_error{ "expected by the test" }; });
+    executor.Post(CodePushPriority::Normal, [ranAfter]() { ranAfter->set_value(); });
+    CHECK(ranAfter->get_future().wait_for(5s) == std::future_status::ready);
+}
+
+int main()
+{
+    TestOrdering();
+    TestStarvation();
+    TestUnhandledError();
+
+    if (s_failures > 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+// The way FileUtils::UnzipAsync built an entry's path before CodePushEntryPath: every segment is copied, decoded
+// with MultiByteToWideChar and sanitized on its own. MultiByteToWideChar is replaced by Utf8ToWide below, which
+// decodes the way it does, so the tests and benchmarks can compare both implementations on any platform.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cwctype>
+#include <string>
+#include <string_view>
+
+namespace Microsoft::CodePush::ReactNative::Legacy
+{
+    // Whether some Unicode scalar value is encoded in n bytes starting with prefix (1 <= prefix.size() <= n).
+    // This works on the code point range the prefix leaves open, not on byte tables, so that it doesn't share
+    // its logic with the decoder under test.
+    inline bool IsPrefixOfEncoding(std::string_view prefix, size_t n)
+    {
+        constexpr uint32_t minimum[]{ 0, 0, 0x80, 0x800, 0x10000 };
+        const auto lead{ static_cast<uint8_t>(prefix[0]) };
+        uint32_t bits{ n == 1 ? lead : static_cast<uint32_t>(lead & (0x7F >> n)) };
+        for (size_t i{ 1 }; i < prefix.size(); i++)
+        {
+            const auto next{ static_cast<uint8_t>(prefix[i]) };
+            if ((next & 0xC0) != 0x80)
+            {
+                return false;
+            }
+            bits = (bits << 6) | (next & 0x3F);
+        }
+
+        const auto openBits{ 6 * (n - prefix.size()) };
+        const auto low{ (std::max)(bits << openBits, minimum[n]) };
+        const auto high{ (std::min)(((bits + 1) << openBits) - 1, uint32_t{ 0x10FFFF }) };
+        return low <= high && !(low >= 0xD800 && high <= 0xDFFF);
+    }
+
+    // UTF-8 to UTF-16 as MultiByteToWideChar(CP_UTF8) does it: well-formed sequences decode to their code point,
+    // and each maximal subpart of an ill-formed one to U+FFFD.
+    inline std::wstring Utf8ToWide(std::string const& utf8)
+    {
+        std::wstring out;
+        size_t i{ 0 };
+        while (i < utf8.size())
+        {
+            const auto lead{ static_cast<uint8_t>(utf8[i]) };
+            const size_t n{ lead < 0x80 ? 1u : lead >= 0xC0 && lead < 0xE0 ? 2u : lead >= 0xE0 && lead < 0xF0 ? 3u : lead >= 0xF0 && lead < 0xF8 ? 4u : 0u };
+
+            size_t length{ 0 };
+            while (n > 0 && length < n && i + length < utf8.size() && IsPrefixOfEncoding(std::string_view{ utf8 }.substr(i, length + 1), n))
+            {
+                length++;
+            }
+            if (length == 0 || length < n)
+            {
+                out.push_back(static_cast<wchar_t>(0xFFFD));
+                i += (std::max)(length, size_t{ 1 });
+                continue;
+            }
+
+            char32_t codePoint{ n == 1 ? lead : static_cast<char32_t>(lead & (0x7F >> n)) };
+            for (size_t j{ 1 }; j < n; j++)
+            {
+                codePoint = (codePoint << 6) | (static_cast<uint8_t>(utf8[i + j]) & 0x3F);
+            }
+            i += n;
+
+            if (codePoint >= 0x10000)
+            {
+                out.push_back(static_cast<wchar_t>(0xD800 + ((codePoint - 0x10000) >> 10)));
+                out.push_back(static_cast<wchar_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+            }
+            else
+            {
+                out.push_back(static_cast<wchar_t>(codePoint));
+            }
+        }
+        return out;
+    }
+
+    // -------------------- sanitizers, as they were in FileUtils.cpp --------------------
+    inline bool IsInvalidChar(wchar_t ch)
+    {
+        switch (ch)
+        {
+        case L'<': case L'>': case L':': case L'"':
+        case L'/': case L'\\': case L'|': case L'?': case L'*':
+            return true;
+        default:
+            return (ch < 0x20); // control chars not allowed in names
+        }
+    }
+
+    inline bool IsReservedDeviceName(const std::wstring& nameNoExtUpper)
+    {
+        static const std::wstring reserved[] = {
+            L"CON", L"PRN", L"AUX", L"NUL",
+            L"COM1", L"COM2", L"COM3", L"COM4", L"COM5", L"COM6", L"COM7", L"COM8", L"COM9",
+            L"LPT1", L"LPT2", L"LPT3", L"LPT4", L"LPT5", L"LPT6", L"LPT7", L"LPT8", L"LPT9"
+        };
+        for (auto const& r : reserved) if (nameNoExtUpper == r) return true;
+        return false;
+    }
+
+    inline void TrimTrailingDotsAndSpaces(std::wstring& s)
+    {
+        while (!s.empty() && (s.back() == L'.' || s.back() == L' ')) s.pop_back();
+    }
+
+    inline void ReplaceInvalidChars(std::wstring& s)
+    {
+        for (auto& ch : s) if (IsInvalidChar(ch)) ch = L'_';
+    }
+
+    // Return false if segment should be skipped entirely
+    inline bool SanitizeSegment(std::wstring& seg)
+    {
+        if (seg.empty()) return false;
+
+        ReplaceInvalidChars(seg);
+        TrimTrailingDotsAndSpaces(seg);
+
+        if (seg.empty() || seg == L"." || seg == L"..") return false;
+
+        // Reserved device names (without extension)
+        std::wstring nameNoExt = seg;
+        auto dot = nameNoExt.find_last_of(L'.');
+        if (dot != std::wstring::npos) nameNoExt = nameNoExt.substr(0, dot);
+
+        std::wstring upper; upper.reserve(nameNoExt.size());
+        for (auto c : nameNoExt) upper.push_back(static_cast<wchar_t>(::towupper(c)));
+        if (IsReservedDeviceName(upper))
+        {
+            // Prefix with underscore to avoid rejection
+            seg.insert(seg.begin(), L'_');
+        }
+
+        // Clamp single segment length to be safe (Windows usually ~255)
+        constexpr size_t kMaxSegmentLen = 240; // headroom
+        if (seg.size() > kMaxSegmentLen)
+        {
+            seg.resize(kMaxSegmentLen);
+            TrimTrailingDotsAndSpaces(seg);
+            if (seg.empty()) return false;
+        }
+
+        return true;
+    }
+
+    // PrepareEntryPath without the root and the folder creation: the sanitized segments joined with '\'.
+    // Returns false if the entry was skipped.
+    inline bool BuildEntryPath(std::string_view entryName, std::wstring& path)
+    {
+        path.clear();
+        size_t start = 0;
+        for (;;)
+        {
+            auto end = entryName.find_first_of("/\\", start);
+            std::wstring segW = Utf8ToWide(std::string{ entryName.substr(start, end == std::string_view::npos ? end : end - start) });
+            if (end == std::string_view::npos)
+            {
+                if (!SanitizeSegment(segW)) return false;
+                if (!path.empty()) path.append(L"\\");
+                path.append(segW);
+                return true;
+            }
+
+            start = end + 1;
+            if (!SanitizeSegment(segW)) continue;
+            if (!path.empty()) path.append(L"\\");
+            path.append(segW);
+        }
+    }
+}